@@ -0,0 +1,105 @@
+#include "bench_utils.h"
+
+#include <vector>
+
+/**
+ * Measures catching up on a backlog with try_read against try_read_batch, and the version scan on
+ * its own
+ */
+
+namespace
+{
+struct Tick
+{
+  uint64_t sequence;
+  uint64_t price;
+  uint64_t quantity;
+};
+
+using queue_t = sq::BoundedSeqlockQueue<Tick>;
+
+constexpr size_t capacity{131072};
+constexpr uint64_t backlog{100'000};
+constexpr uint32_t repetitions{50};
+
+/***/
+template <typename TDrain>
+void run_drain(char const* name, TDrain drain)
+{
+  queue_t queue{capacity};
+  sq::SeqlockQueueProducer<queue_t> producer{queue};
+  sq::SeqlockQueueConsumer<queue_t> consumer{queue};
+
+  uint64_t elapsed{0};
+  uint64_t sequence{0};
+
+  for (uint32_t r = 0; r < repetitions; ++r)
+  {
+    for (uint64_t i = 0; i < backlog; ++i, ++sequence)
+    {
+      producer.write(Tick{sequence, sequence, sequence});
+    }
+
+    uint64_t const start = sq::bench::now_ns();
+    uint64_t const received = drain(consumer);
+    elapsed += sq::bench::now_ns() - start;
+
+    if (received != backlog)
+    {
+      std::printf("unexpected number of messages %llu\n", static_cast<unsigned long long>(received));
+    }
+  }
+
+  sq::bench::report(name, backlog * repetitions, elapsed);
+}
+
+/***/
+void run_scan(char const* name)
+{
+  std::vector<sq::Slot<Tick, 64>> slots(capacity);
+  for (uint64_t i = 0; i < capacity; ++i)
+  {
+    slots[i].version.store(sq::detail::published_version(i));
+  }
+
+  uint64_t const start = sq::bench::now_ns();
+  for (uint32_t r = 0; r < repetitions; ++r)
+  {
+    sq::bench::do_not_optimize(sq::detail::published_run(slots.data(), capacity - 1, 0, backlog));
+  }
+  sq::bench::report(name, backlog * repetitions, sq::bench::now_ns() - start);
+}
+} // namespace
+
+int main()
+{
+  run_drain("drain 100k backlog, try_read",
+            [](sq::SeqlockQueueConsumer<queue_t>& consumer)
+            {
+              uint64_t received{0};
+              Tick result;
+              while (consumer.try_read(result))
+              {
+                sq::bench::do_not_optimize(result);
+                ++received;
+              }
+              return received;
+            });
+
+  run_drain("drain 100k backlog, try_read_batch(256)",
+            [](sq::SeqlockQueueConsumer<queue_t>& consumer)
+            {
+              uint64_t received{0};
+              static Tick results[256];
+              while (size_t const count = consumer.try_read_batch(results, 256))
+              {
+                sq::bench::do_not_optimize(results);
+                received += count;
+              }
+              return received;
+            });
+
+  run_scan("version scan");
+
+  return 0;
+}
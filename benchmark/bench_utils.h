@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+#if defined(__linux__)
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+#include "seqlock_queue/seqlock_queue.h"
+
+namespace sq::bench
+{
+/***/
+inline void pin_to_cpu(unsigned cpu) noexcept
+{
+#if defined(__linux__)
+  unsigned const cpus = std::thread::hardware_concurrency();
+
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpus ? cpu % cpus : 0u, &cpu_set);
+  pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+#else
+  (void)cpu;
+#endif
+}
+
+/***/
+inline uint64_t now_ns() noexcept
+{
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count());
+}
+
+/**
+ * Prevents the compiler from optimising away the computation of value
+ */
+template <typename T>
+inline void do_not_optimize(T const& value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+  (void)value;
+#endif
+}
+
+/***/
+inline void report(char const* name, uint64_t messages, uint64_t elapsed_ns) noexcept
+{
+  double const ns_per_message = static_cast<double>(elapsed_ns) / static_cast<double>(messages);
+  std::printf("%-56s %10.2f ns/msg %10.2f Mmsg/s\n", name, ns_per_message, 1e3 / ns_per_message);
+}
+
+/**
+ * Writes and reads back one message at a time on a single thread, this measures the cost of the
+ * write and read paths without any cache line transfers
+ */
+template <typename TQueue, typename TProducer = SeqlockQueueProducer<TQueue>,
+          typename TConsumer = SeqlockQueueConsumer<TQueue>, typename TMakeValue>
+void run_single_thread(char const* name, size_t capacity, uint64_t messages, TMakeValue make_value)
+{
+  TQueue queue{capacity};
+  TProducer producer{queue};
+  TConsumer consumer{queue};
+
+  typename TQueue::value_t result;
+
+  uint64_t const start = now_ns();
+  for (uint64_t i = 0; i < messages; ++i)
+  {
+    producer.write(make_value(i));
+    consumer.try_read(result);
+    do_not_optimize(result);
+  }
+  report(name, messages, now_ns() - start);
+}
+
+/**
+ * Only writes, with a ring larger than the caches every slot the producer reaches is a cache miss
+ */
+template <typename TQueue, typename TProducer = SeqlockQueueProducer<TQueue>, typename TMakeValue>
+void run_producer_only(char const* name, size_t capacity, uint64_t messages, TMakeValue make_value)
+{
+  TQueue queue{capacity};
+  TProducer producer{queue};
+
+  uint64_t const start = now_ns();
+  for (uint64_t i = 0; i < messages; ++i)
+  {
+    producer.write(make_value(i));
+  }
+  report(name, messages, now_ns() - start);
+}
+
+/**
+ * A producer thread writes as fast as it can while a consumer thread drains the queue. Reports the
+ * consumer's view, slow consumers drop messages so the received count is printed too
+ */
+template <typename TQueue, typename TProducer = SeqlockQueueProducer<TQueue>,
+          typename TConsumer = SeqlockQueueConsumer<TQueue>, typename TMakeValue>
+void run_throughput(char const* name, size_t capacity, uint64_t messages, TMakeValue make_value)
+{
+  TQueue queue{capacity};
+  TProducer producer{queue};
+
+  std::atomic<bool> consumer_ready{false};
+  std::atomic<bool> producer_done{false};
+  uint64_t received{0};
+  uint64_t consumer_ns{0};
+
+  std::thread consumer_thread{[&]()
+                              {
+                                pin_to_cpu(1);
+                                TConsumer consumer{queue};
+                                typename TQueue::value_t result;
+
+                                consumer_ready.store(true);
+
+                                uint64_t const start = now_ns();
+                                while (!producer_done.load(std::memory_order_relaxed))
+                                {
+                                  while (consumer.try_read(result))
+                                  {
+                                    do_not_optimize(result);
+                                    ++received;
+                                  }
+                                }
+
+                                while (consumer.try_read(result))
+                                {
+                                  ++received;
+                                }
+                                consumer_ns = now_ns() - start;
+                              }};
+
+  pin_to_cpu(0);
+
+  while (!consumer_ready.load())
+  {
+    std::this_thread::yield();
+  }
+
+  for (uint64_t i = 0; i < messages; ++i)
+  {
+    producer.write(make_value(i));
+  }
+  producer_done.store(true);
+
+  consumer_thread.join();
+
+  report(name, received ? received : 1, consumer_ns);
+  std::printf("%-56s %10llu/%llu received\n", "", static_cast<unsigned long long>(received),
+              static_cast<unsigned long long>(messages));
+}
+} // namespace sq::bench
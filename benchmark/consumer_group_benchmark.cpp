@@ -0,0 +1,100 @@
+#include "bench_utils.h"
+
+#include "seqlock_queue/consumer_group.h"
+
+#include <vector>
+
+/**
+ * A consumer group splitting a feed of CPU heavy messages between 1 to 16 workers, each worker
+ * pinned to its own cpu when there are enough of them
+ */
+
+namespace
+{
+struct Order
+{
+  uint64_t id;
+  uint64_t price;
+  uint64_t quantity;
+};
+
+using queue_t = sq::BoundedSeqlockQueue<Order>;
+
+constexpr size_t capacity{1u << 20u};
+constexpr uint64_t messages{1u << 20u};
+constexpr uint32_t work_iterations{200};
+
+/**
+ * Stands in for a risk recalculation
+ */
+uint64_t process(Order const& order) noexcept
+{
+  uint64_t value = order.price;
+  for (uint32_t i = 0; i < work_iterations; ++i)
+  {
+    value = value * 6364136223846793005ull + order.quantity;
+  }
+  return value;
+}
+
+/***/
+void run_workers(size_t workers)
+{
+  queue_t queue{capacity};
+  sq::SeqlockQueueProducer<queue_t> producer{queue};
+  sq::ConsumerGroup group{queue};
+
+  // the whole feed is written first, the workers only compete for the claims
+  for (uint64_t i = 0; i < messages; ++i)
+  {
+    producer.write(Order{i, i, i});
+  }
+
+  std::atomic<uint64_t> processed{0};
+  std::vector<std::thread> threads;
+
+  uint64_t const start = sq::bench::now_ns();
+
+  for (size_t w = 0; w < workers; ++w)
+  {
+    threads.emplace_back(
+      [&queue, &group, &processed, w]()
+      {
+        sq::bench::pin_to_cpu(static_cast<unsigned>(w + 1));
+        sq::SeqlockQueueGroupConsumer<queue_t> member{queue, group};
+
+        Order order;
+        uint64_t count{0};
+
+        while (member.try_read(order) != sq::ReadResult::Empty)
+        {
+          sq::bench::do_not_optimize(process(order));
+          ++count;
+        }
+
+        processed.fetch_add(count);
+      });
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  uint64_t const elapsed = sq::bench::now_ns() - start;
+
+  char name[64];
+  std::snprintf(name, sizeof(name), "consumer group, %zu workers", workers);
+  sq::bench::report(name, processed.load(), elapsed);
+}
+} // namespace
+
+int main()
+{
+  for (size_t workers : {1u, 2u, 4u, 8u, 16u})
+  {
+    run_workers(workers);
+  }
+
+  return 0;
+}
@@ -0,0 +1,82 @@
+#include "bench_utils.h"
+
+/**
+ * Measures the payload copy kernels per payload size, on their own and through the queue
+ */
+
+namespace
+{
+template <size_t Size>
+struct Payload
+{
+  uint8_t bytes[Size];
+};
+
+/***/
+template <size_t Size>
+void run_copy(char const* kernel_name, sq::detail::SimdLevel kernel)
+{
+  constexpr uint64_t iterations{10'000'000};
+
+  // source and destination stay in L1, this measures the copy itself
+  alignas(64) static Payload<Size> src{};
+  alignas(64) static Payload<Size> dst{};
+
+  uint64_t const start = sq::bench::now_ns();
+  for (uint64_t i = 0; i < iterations; ++i)
+  {
+    src.bytes[0] = static_cast<uint8_t>(i);
+    sq::detail::copy_value(dst, src, kernel);
+    sq::bench::do_not_optimize(dst);
+  }
+
+  char name[64];
+  std::snprintf(name, sizeof(name), "copy %zu bytes %s", Size, kernel_name);
+  sq::bench::report(name, iterations, sq::bench::now_ns() - start);
+}
+
+/***/
+template <size_t Size>
+void run_size()
+{
+  run_copy<Size>("scalar", sq::detail::SimdLevel::Scalar);
+
+#if defined(SEQLOCK_QUEUE_CPU_DISPATCH)
+  if (__builtin_cpu_supports("avx2"))
+  {
+    run_copy<Size>("avx2", sq::detail::SimdLevel::Avx2);
+  }
+
+  if (__builtin_cpu_supports("avx512f"))
+  {
+    run_copy<Size>("avx512", sq::detail::SimdLevel::Avx512);
+  }
+#endif
+
+  char name[64];
+  std::snprintf(name, sizeof(name), "queue single_thread %zu bytes", Size);
+
+  using queue_t = sq::BoundedSeqlockQueue<Payload<Size>>;
+  sq::bench::run_single_thread<queue_t>(name, 1024, 5'000'000,
+                                        [](uint64_t i)
+                                        {
+                                          Payload<Size> payload;
+                                          payload.bytes[0] = static_cast<uint8_t>(i);
+                                          return payload;
+                                        });
+
+  std::printf("\n");
+}
+} // namespace
+
+int main()
+{
+  run_size<256>();
+  run_size<512>();
+  run_size<1024>();
+  run_size<1536>();
+  run_size<2048>();
+  run_size<4096>();
+
+  return 0;
+}
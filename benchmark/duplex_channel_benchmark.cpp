@@ -0,0 +1,104 @@
+#include "bench_utils.h"
+
+#include "seqlock_queue/duplex_channel.h"
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * Ping pong over a DuplexChannel, the client and the server pinned to different cpus. Prints the
+ * round trip time percentiles of call(). With fewer than two cpus the two threads share one and
+ * only the yielding run gives meaningful, scheduler bound, numbers
+ */
+
+namespace
+{
+struct NewOrder
+{
+  uint64_t order_id;
+  uint64_t price;
+  uint64_t quantity;
+  uint64_t client_ns;
+};
+
+struct OrderAck
+{
+  uint64_t order_id;
+  uint64_t status;
+};
+
+using channel_t = sq::DuplexChannel<NewOrder, OrderAck>;
+
+constexpr uint64_t warmup_calls{10'000};
+
+/***/
+void run_ping_pong(sq::WaitStrategy wait_strategy, char const* name, uint64_t calls)
+{
+  channel_t channel{64};
+  std::atomic<bool> running{true};
+
+  std::thread server_thread{[&channel, &running, wait_strategy]()
+                            {
+                              sq::bench::pin_to_cpu(1);
+                              sq::DuplexChannelServer<channel_t> server{channel, wait_strategy};
+
+                              uint64_t correlation_id;
+                              NewOrder order;
+
+                              while (running.load(std::memory_order_relaxed))
+                              {
+                                if (server.try_receive(correlation_id, order))
+                                {
+                                  server.reply(correlation_id, OrderAck{order.order_id, 1});
+                                }
+                                else if (wait_strategy == sq::WaitStrategy::Yield)
+                                {
+                                  std::this_thread::yield();
+                                }
+                              }
+                            }};
+
+  sq::bench::pin_to_cpu(0);
+  sq::DuplexChannelClient<channel_t> client{channel, wait_strategy};
+
+  std::vector<uint64_t> round_trips;
+  round_trips.reserve(calls);
+
+  OrderAck ack;
+  for (uint64_t i = 0; i < warmup_calls + calls; ++i)
+  {
+    uint64_t const start = sq::bench::now_ns();
+    client.call(NewOrder{i, 100, 1, start}, ack);
+    uint64_t const end = sq::bench::now_ns();
+
+    if (i >= warmup_calls)
+    {
+      round_trips.push_back(end - start);
+    }
+  }
+
+  running.store(false);
+  server_thread.join();
+
+  std::sort(round_trips.begin(), round_trips.end());
+
+  auto const percentile = [&round_trips](double p)
+  { return round_trips[static_cast<size_t>(p * static_cast<double>(round_trips.size() - 1))]; };
+
+  std::printf("%-56s p50 %8llu ns  p99 %8llu ns  p99.9 %8llu ns\n", name,
+              static_cast<unsigned long long>(percentile(0.5)), static_cast<unsigned long long>(percentile(0.99)),
+              static_cast<unsigned long long>(percentile(0.999)));
+}
+} // namespace
+
+int main()
+{
+  if (std::thread::hardware_concurrency() >= 2)
+  {
+    run_ping_pong(sq::WaitStrategy::Spin, "duplex channel round trip, spinning", 1'000'000);
+  }
+
+  run_ping_pong(sq::WaitStrategy::Yield, "duplex channel round trip, yielding", 100'000);
+
+  return 0;
+}
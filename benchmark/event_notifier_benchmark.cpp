@@ -0,0 +1,141 @@
+#include "bench_utils.h"
+
+#include "seqlock_queue/event_notifier.h"
+
+#include <algorithm>
+#include <sys/epoll.h>
+#include <vector>
+
+/**
+ * What an EventNotifier adds to a write while no consumer waits, the cost of a whole arm, wake and
+ * acknowledge cycle, and the latency from a write to an epoll consumer reading the message. The
+ * wake latency is dominated by the scheduler, on a single cpu more so
+ */
+
+namespace
+{
+struct Quote
+{
+  uint64_t instrument;
+  uint64_t bid;
+  uint64_t ask;
+  uint64_t timestamp;
+};
+
+using queue_t = sq::BoundedSeqlockQueue<Quote>;
+
+constexpr uint64_t messages{1u << 22u};
+constexpr uint64_t wake_cycles{100'000};
+constexpr uint64_t wake_messages{5'000};
+
+/***/
+void run_producer_overhead()
+{
+  for (bool attached : {false, true})
+  {
+    queue_t queue{1024};
+    sq::EventNotifier notifier;
+    sq::SeqlockQueueProducer<queue_t> producer{queue};
+
+    if (attached)
+    {
+      producer.set_notifier(notifier);
+    }
+
+    uint64_t const start = sq::bench::now_ns();
+    for (uint64_t i = 0; i < messages; ++i)
+    {
+      producer.write(Quote{i, i, i, i});
+    }
+
+    sq::bench::report(attached ? "write, notifier not armed" : "write without a notifier", messages,
+                      sq::bench::now_ns() - start);
+  }
+}
+
+/**
+ * Arming, the write that wakes the consumer and the acknowledgement, on one thread
+ */
+void run_wake_cycle()
+{
+  queue_t queue{1024};
+  sq::EventNotifier notifier;
+  sq::SeqlockQueueProducer<queue_t> producer{queue};
+  producer.set_notifier(notifier);
+
+  uint64_t const start = sq::bench::now_ns();
+  for (uint64_t i = 0; i < wake_cycles; ++i)
+  {
+    notifier.arm();
+    producer.write(Quote{i, i, i, i});
+    notifier.acknowledge();
+  }
+
+  sq::bench::report("arm, wake and acknowledge (ns/cycle)", wake_cycles, sq::bench::now_ns() - start);
+}
+
+/***/
+void run_wake_latency()
+{
+  queue_t queue{1024, false, 1};
+  sq::EventNotifier notifier;
+
+  std::vector<uint64_t> latencies;
+  latencies.reserve(wake_messages);
+
+  std::thread consumer_thread{[&queue, &notifier, &latencies]()
+                              {
+                                sq::bench::pin_to_cpu(1);
+                                sq::SeqlockQueueConsumer<queue_t> consumer{queue, sq::ConsumerMode::Lossless};
+
+                                int const epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+                                epoll_event event{};
+                                event.events = EPOLLIN;
+                                ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, notifier.fd(), &event);
+
+                                Quote quote;
+                                while (latencies.size() != wake_messages)
+                                {
+                                  while (consumer.try_read(quote))
+                                  {
+                                    latencies.push_back(sq::bench::now_ns() - quote.timestamp);
+                                  }
+
+                                  if ((latencies.size() != wake_messages) && notifier.arm(consumer))
+                                  {
+                                    ::epoll_wait(epoll_fd, &event, 1, -1);
+                                    notifier.acknowledge();
+                                  }
+                                }
+
+                                ::close(epoll_fd);
+                              }};
+
+  sq::bench::pin_to_cpu(0);
+  sq::SeqlockQueueProducer<queue_t> producer{queue};
+  producer.set_notifier(notifier);
+
+  // Spaced out so the consumer is asleep when each message is written
+  for (uint64_t i = 0; i < wake_messages; ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::microseconds{100});
+    producer.write(Quote{i, i, i, sq::bench::now_ns()});
+  }
+
+  consumer_thread.join();
+
+  std::sort(latencies.begin(), latencies.end());
+  std::printf("%-56s p50 %8llu ns  p99 %8llu ns\n", "wake latency, epoll consumer",
+              static_cast<unsigned long long>(latencies[latencies.size() / 2]),
+              static_cast<unsigned long long>(latencies[latencies.size() * 99 / 100]));
+}
+} // namespace
+
+int main()
+{
+  run_producer_overhead();
+  run_wake_cycle();
+  run_wake_latency();
+
+  return 0;
+}
@@ -0,0 +1,105 @@
+#include "bench_utils.h"
+
+#include <vector>
+
+/**
+ * A consumer interested in 10% of the feed, selecting by a symbol in the value against selecting
+ * by the slot tag with try_read_if
+ */
+
+namespace
+{
+struct BookUpdate
+{
+  uint64_t symbol;
+  uint64_t levels[63];
+};
+
+constexpr size_t capacity{131072};
+constexpr uint64_t backlog{100'000};
+constexpr uint32_t repetitions{20};
+constexpr uint64_t symbols{10};
+
+/***/
+template <typename TQueue, typename TDrain>
+void run_drain(char const* name, TDrain drain)
+{
+  TQueue queue{capacity};
+  sq::SeqlockQueueProducer<TQueue> producer{queue};
+  sq::SeqlockQueueConsumer<TQueue> consumer{queue};
+
+  BookUpdate update{};
+  uint64_t elapsed{0};
+  uint64_t copied_bytes{0};
+
+  for (uint32_t r = 0; r < repetitions; ++r)
+  {
+    for (uint64_t i = 0; i < backlog; ++i)
+    {
+      update.symbol = i % symbols;
+      producer.write(update, uint64_t{1} << update.symbol);
+    }
+
+    uint64_t const start = sq::bench::now_ns();
+    uint64_t const copies = drain(consumer);
+    elapsed += sq::bench::now_ns() - start;
+
+    copied_bytes += copies * sizeof(BookUpdate);
+  }
+
+  sq::bench::report(name, backlog * repetitions, elapsed);
+  std::printf("%-56s %10.2f bytes copied/msg\n", "",
+              static_cast<double>(copied_bytes) / static_cast<double>(backlog * repetitions));
+}
+} // namespace
+
+int main()
+{
+  using queue_t = sq::BoundedSeqlockQueue<BookUpdate>;
+  using tagged_queue_t = sq::BoundedSeqlockQueue<BookUpdate, 64, 64, true>;
+
+  run_drain<queue_t>("10% selectivity, try_read and check the symbol",
+                     [](sq::SeqlockQueueConsumer<queue_t>& consumer)
+                     {
+                       uint64_t copies{0};
+                       BookUpdate result;
+                       while (consumer.try_read(result))
+                       {
+                         ++copies;
+                         if (result.symbol == 3)
+                         {
+                           sq::bench::do_not_optimize(result);
+                         }
+                       }
+                       return copies;
+                     });
+
+  run_drain<tagged_queue_t>("10% selectivity, try_read_if(TagMask)",
+                            [](sq::SeqlockQueueConsumer<tagged_queue_t>& consumer)
+                            {
+                              uint64_t copies{0};
+                              BookUpdate result;
+                              while (consumer.try_read_if(result, sq::TagMask{uint64_t{1} << 3}))
+                              {
+                                ++copies;
+                                sq::bench::do_not_optimize(result);
+                              }
+                              return copies;
+                            });
+
+  run_drain<tagged_queue_t>("10% selectivity, try_read_batch_if(TagMask, 256)",
+                            [](sq::SeqlockQueueConsumer<tagged_queue_t>& consumer)
+                            {
+                              uint64_t copies{0};
+                              static BookUpdate results[256];
+                              while (size_t const count =
+                                       consumer.try_read_batch_if(results, 256, sq::TagMask{uint64_t{1} << 3}))
+                              {
+                                copies += count;
+                                sq::bench::do_not_optimize(results);
+                              }
+                              return copies;
+                            });
+
+  return 0;
+}
@@ -0,0 +1,87 @@
+#include "bench_utils.h"
+
+#include "seqlock_queue/merge_consumer.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * Merging K venue feeds by timestamp for K from 4 to 32. Each round writes a chunk of events with
+ * interleaved timestamps to every queue and merges them back, single threaded, so the numbers are
+ * the cost of the merge itself
+ */
+
+namespace
+{
+struct Event
+{
+  uint64_t timestamp;
+  uint64_t venue;
+  uint64_t price;
+  uint64_t quantity;
+};
+
+using queue_t = sq::BoundedSeqlockQueue<Event>;
+
+constexpr size_t capacity{4096};
+constexpr uint64_t chunk{1024};
+constexpr uint64_t messages{1u << 22u};
+
+/***/
+void run_merge(size_t queue_count)
+{
+  std::vector<std::unique_ptr<queue_t>> queues;
+  std::vector<std::unique_ptr<sq::SeqlockQueueProducer<queue_t>>> producers;
+  std::vector<queue_t*> queue_pointers;
+
+  for (size_t i = 0; i < queue_count; ++i)
+  {
+    queues.push_back(std::make_unique<queue_t>(capacity));
+    producers.push_back(std::make_unique<sq::SeqlockQueueProducer<queue_t>>(*queues.back()));
+    queue_pointers.push_back(queues.back().get());
+  }
+
+  auto const key = [](Event const& event) { return event.timestamp; };
+  sq::SeqlockQueueMergeConsumer<queue_t, decltype(key)> merge_consumer{queue_pointers, key};
+
+  Event event;
+  uint64_t timestamp{0};
+  uint64_t elapsed{0};
+  uint64_t merged{0};
+
+  while (merged < messages)
+  {
+    // The venues take turns in an uneven pattern, so the heap order changes all the time
+    for (uint64_t i = 0; i < chunk * queue_count; ++i)
+    {
+      size_t const venue = (i * 7 + (i >> 3)) % queue_count;
+      producers[venue]->write(Event{timestamp++, venue, i, i});
+    }
+
+    uint64_t const start = sq::bench::now_ns();
+
+    // Stops when a venue runs out, its next event could have the smallest timestamp
+    while (merge_consumer.try_read(event))
+    {
+      sq::bench::do_not_optimize(event);
+      ++merged;
+    }
+
+    elapsed += sq::bench::now_ns() - start;
+  }
+
+  char name[64];
+  std::snprintf(name, sizeof(name), "merge consumer, %zu queues", queue_count);
+  sq::bench::report(name, merged, elapsed);
+}
+} // namespace
+
+int main()
+{
+  for (size_t queue_count : {4u, 8u, 16u, 32u})
+  {
+    run_merge(queue_count);
+  }
+
+  return 0;
+}
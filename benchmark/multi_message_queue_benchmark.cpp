@@ -0,0 +1,168 @@
+#include "bench_utils.h"
+
+#include "seqlock_queue/multi_message_queue.h"
+
+#include <variant>
+
+/**
+ * A feed of 12 message types from 8 to 256 bytes, mostly small quotes, through a MultiMessageSeqlockQueue
+ * compared with a BoundedSeqlockQueue of std::variant. The producer fills the ring and the consumer
+ * then drains it, the two are timed separately. Single threaded
+ */
+
+namespace
+{
+template <size_t Size>
+struct Message
+{
+  uint64_t id;
+  std::byte payload[Size - sizeof(uint64_t)];
+};
+
+template <>
+struct Message<sizeof(uint64_t)>
+{
+  uint64_t id;
+};
+
+using Heartbeat = Message<8>;
+using Quote = Message<24>;
+using Trade = Message<32>;
+using OrderAdd = Message<40>;
+using OrderModify = Message<48>;
+using OrderDelete = Message<16>;
+using Status = Message<64>;
+using Imbalance = Message<96>;
+using Auction = Message<128>;
+using Statistics = Message<160>;
+using Instrument = Message<200>;
+using Snapshot = Message<256>;
+
+/**
+ * TMessages instantiated with every message type of the feed
+ */
+template <template <typename...> typename TMessages>
+using feed_t = TMessages<Heartbeat, Quote, Trade, OrderAdd, OrderModify, OrderDelete, Status, Imbalance, Auction,
+                         Statistics, Instrument, Snapshot>;
+
+using variant_t = feed_t<std::variant>;
+using variant_queue_t = sq::BoundedSeqlockQueue<variant_t>;
+using multi_message_queue_t = feed_t<sq::MultiMessageSeqlockQueue>;
+
+constexpr size_t capacity{1u << 14u};
+constexpr uint64_t rounds{256};
+
+struct Visitor
+{
+  template <typename TMessage>
+  void operator()(TMessage const& message) noexcept
+  {
+    sum += message.id + sizeof(TMessage);
+  }
+
+  uint64_t sum{0};
+};
+
+/**
+ * 15 in 16 messages are quotes, the rest cycles through the other types
+ */
+template <typename TWrite>
+void write_feed(uint64_t i, TWrite&& write)
+{
+  if ((i % 16) != 0)
+  {
+    write(Quote{i, {}});
+    return;
+  }
+
+  switch ((i / 16) % 11)
+  {
+  case 0: write(Heartbeat{i}); break;
+  case 1: write(Trade{i, {}}); break;
+  case 2: write(OrderAdd{i, {}}); break;
+  case 3: write(OrderModify{i, {}}); break;
+  case 4: write(OrderDelete{i, {}}); break;
+  case 5: write(Status{i, {}}); break;
+  case 6: write(Imbalance{i, {}}); break;
+  case 7: write(Auction{i, {}}); break;
+  case 8: write(Statistics{i, {}}); break;
+  case 9: write(Instrument{i, {}}); break;
+  default: write(Snapshot{i, {}}); break;
+  }
+}
+
+/***/
+void run_variant()
+{
+  variant_queue_t queue{capacity};
+  sq::SeqlockQueueProducer<variant_queue_t> producer{queue};
+  sq::SeqlockQueueConsumer<variant_queue_t> consumer{queue};
+
+  Visitor visitor;
+  variant_t value;
+  uint64_t write_ns{0};
+  uint64_t read_ns{0};
+
+  for (uint64_t round = 0; round < rounds; ++round)
+  {
+    uint64_t start = sq::bench::now_ns();
+    for (uint64_t i = 0; i < capacity; ++i)
+    {
+      write_feed(i, [&producer](auto const& message) { producer.write(variant_t{message}); });
+    }
+    write_ns += sq::bench::now_ns() - start;
+
+    start = sq::bench::now_ns();
+    while (consumer.try_read(value))
+    {
+      std::visit(visitor, value);
+    }
+    read_ns += sq::bench::now_ns() - start;
+  }
+
+  sq::bench::do_not_optimize(visitor.sum);
+  std::printf("std::variant slot size %zu bytes\n", sizeof(variant_queue_t::slot_t));
+  sq::bench::report("std::variant queue, write", rounds * capacity, write_ns);
+  sq::bench::report("std::variant queue, read and visit", rounds * capacity, read_ns);
+}
+
+/***/
+void run_multi_message()
+{
+  multi_message_queue_t queue{capacity};
+  sq::MultiMessageSeqlockQueueProducer<multi_message_queue_t> producer{queue};
+  sq::MultiMessageSeqlockQueueConsumer<multi_message_queue_t> consumer{queue};
+
+  Visitor visitor;
+  uint64_t write_ns{0};
+  uint64_t read_ns{0};
+
+  for (uint64_t round = 0; round < rounds; ++round)
+  {
+    uint64_t start = sq::bench::now_ns();
+    for (uint64_t i = 0; i < capacity; ++i)
+    {
+      write_feed(i, [&producer](auto const& message) { producer.write(message); });
+    }
+    write_ns += sq::bench::now_ns() - start;
+
+    start = sq::bench::now_ns();
+    while (consumer.try_read(visitor))
+    {
+    }
+    read_ns += sq::bench::now_ns() - start;
+  }
+
+  sq::bench::do_not_optimize(visitor.sum);
+  std::printf("multi message slot size %zu bytes\n", sizeof(multi_message_queue_t::slot_t));
+  sq::bench::report("multi message queue, write", rounds * capacity, write_ns);
+  sq::bench::report("multi message queue, read and visit", rounds * capacity, read_ns);
+}
+} // namespace
+
+int main()
+{
+  run_variant();
+  run_multi_message();
+  return 0;
+}
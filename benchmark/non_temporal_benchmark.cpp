@@ -0,0 +1,139 @@
+#include "bench_utils.h"
+
+#include <vector>
+
+/**
+ * Compares the default write with write_non_temporal for large slots.
+ *
+ * The first benchmark has the producer touch a hot working set between writes, the time it takes
+ * shows how much of it the slot writes evict. The second measures the latency a consumer on
+ * another core sees between the write and the read.
+ */
+
+namespace
+{
+struct Snapshot
+{
+  uint64_t timestamp;
+  uint8_t levels[1016];
+};
+
+using queue_t = sq::BoundedSeqlockQueue<Snapshot>;
+
+/***/
+template <bool NonTemporal>
+void run_working_set(char const* name)
+{
+  // the ring is larger than the caches, the working set fits in L2
+  constexpr size_t capacity{16384};
+  constexpr size_t working_set_size{256 * 1024};
+  constexpr uint64_t iterations{1'000'000};
+
+  queue_t queue{capacity};
+  sq::SeqlockQueueProducer<queue_t> producer{queue};
+
+  std::vector<uint64_t> working_set(working_set_size / sizeof(uint64_t), 1);
+  Snapshot snapshot{};
+
+  uint64_t sum{0};
+  uint64_t const start = sq::bench::now_ns();
+  for (uint64_t i = 0; i < iterations; ++i)
+  {
+    snapshot.timestamp = i;
+
+    if constexpr (NonTemporal)
+    {
+      producer.write_non_temporal(snapshot);
+    }
+    else
+    {
+      producer.write(snapshot);
+    }
+
+    // touch one line in every page of the working set
+    for (size_t j = (i % 8u) * 8u; j < working_set.size(); j += 512u)
+    {
+      sum += working_set[j];
+    }
+  }
+  sq::bench::do_not_optimize(sum);
+  sq::bench::report(name, iterations, sq::bench::now_ns() - start);
+}
+
+/***/
+template <bool NonTemporal>
+void run_latency(char const* name)
+{
+  constexpr size_t capacity{16384};
+  constexpr uint64_t messages{1'000'000};
+
+  queue_t queue{capacity};
+  sq::SeqlockQueueProducer<queue_t> producer{queue};
+
+  std::atomic<bool> consumer_ready{false};
+  std::atomic<bool> producer_done{false};
+  uint64_t total_latency{0};
+  uint64_t received{0};
+
+  std::thread consumer_thread{[&]()
+                              {
+                                sq::bench::pin_to_cpu(1);
+                                sq::SeqlockQueueConsumer<queue_t> consumer{queue};
+                                Snapshot result;
+
+                                consumer_ready.store(true);
+
+                                while (!producer_done.load(std::memory_order_relaxed))
+                                {
+                                  if (consumer.try_read(result))
+                                  {
+                                    total_latency += sq::bench::now_ns() - result.timestamp;
+                                    ++received;
+                                  }
+                                }
+                              }};
+
+  sq::bench::pin_to_cpu(0);
+
+  while (!consumer_ready.load())
+  {
+    std::this_thread::yield();
+  }
+
+  Snapshot snapshot{};
+  for (uint64_t i = 0; i < messages; ++i)
+  {
+    // pace the producer so that the consumer keeps up
+    uint64_t const next = sq::bench::now_ns() + 500;
+    while (sq::bench::now_ns() < next)
+    {
+    }
+
+    snapshot.timestamp = sq::bench::now_ns();
+
+    if constexpr (NonTemporal)
+    {
+      producer.write_non_temporal(snapshot);
+    }
+    else
+    {
+      producer.write(snapshot);
+    }
+  }
+  producer_done.store(true);
+  consumer_thread.join();
+
+  sq::bench::report(name, received ? received : 1, total_latency);
+}
+} // namespace
+
+int main()
+{
+  run_working_set<false>("producer working set, write");
+  run_working_set<true>("producer working set, write_non_temporal");
+
+  run_latency<false>("consumer latency, write");
+  run_latency<true>("consumer latency, write_non_temporal");
+
+  return 0;
+}
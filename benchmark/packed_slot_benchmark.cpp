@@ -0,0 +1,39 @@
+#include "bench_utils.h"
+
+/**
+ * Compares the generic seqlock slot with the packed 16 byte slot, where the version and the value
+ * are published with one store and read with one load
+ */
+
+namespace
+{
+struct Quote
+{
+  int32_t price;
+  uint32_t quantity;
+};
+
+Quote make_quote(uint64_t i) noexcept
+{
+  return Quote{static_cast<int32_t>(i), static_cast<uint32_t>(i)};
+}
+} // namespace
+
+int main()
+{
+  using generic_queue_t = sq::BoundedSeqlockQueue<Quote>;
+  using packed_queue_t = sq::BoundedSeqlockQueue<Quote, 16>;
+
+  constexpr size_t capacity{4096};
+  constexpr uint64_t messages{50'000'000};
+
+  std::printf("atomic 16 byte access: %s\n\n", sq::detail::has_atomic_16b_access() ? "yes" : "no");
+
+  sq::bench::run_single_thread<generic_queue_t>("single_thread generic slot", capacity, messages, make_quote);
+  sq::bench::run_single_thread<packed_queue_t>("single_thread packed slot", capacity, messages, make_quote);
+
+  sq::bench::run_throughput<generic_queue_t>("throughput generic slot", capacity, messages, make_quote);
+  sq::bench::run_throughput<packed_queue_t>("throughput packed slot", capacity, messages, make_quote);
+
+  return 0;
+}
@@ -0,0 +1,174 @@
+#include "bench_utils.h"
+
+#include "seqlock_queue/pipeline.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * Three processing stages, each on its own thread, working in place on one ring with sequence barriers
+ * compared with the same stages chained by three queues that copy every message at every hop.
+ * The stages yield when idle, on a machine with fewer than four cpus the threads share cores and the
+ * latency is dominated by the scheduler rather than the hand off
+ */
+
+namespace
+{
+struct Order
+{
+  uint64_t id;
+  uint64_t price;
+  uint64_t quantity;
+  uint64_t created_ns;
+  uint64_t payload[4];
+};
+
+using queue_t = sq::BoundedSeqlockQueue<Order>;
+
+constexpr size_t capacity{1u << 12u};
+constexpr uint64_t messages{1u << 20u};
+
+/***/
+void run_pipeline()
+{
+  queue_t queue{capacity, false, 3};
+  sq::SeqlockQueueProducer<queue_t> producer{queue, sq::WaitStrategy::Yield};
+
+  sq::SeqlockQueueStage<queue_t> decode{queue};
+  sq::SeqlockQueueStage<queue_t> enrich{queue, {&decode}};
+  sq::SeqlockQueueStage<queue_t> publish{queue, {&enrich}};
+
+  sq::StageSideArray<uint64_t> notional{capacity};
+
+  uint64_t total_latency_ns{0};
+
+  auto run_stage = [](sq::SeqlockQueueStage<queue_t>& stage, unsigned cpu, auto callback)
+  {
+    return std::thread{[&stage, cpu, callback]() mutable
+                       {
+                         sq::bench::pin_to_cpu(cpu);
+                         while (stage.sequence() != messages)
+                         {
+                           if (stage.process(callback) == 0)
+                           {
+                             std::this_thread::yield();
+                           }
+                         }
+                       }};
+  };
+
+  std::thread decode_thread =
+    run_stage(decode, 1, [](Order const& order, uint64_t) { sq::bench::do_not_optimize(order.id); });
+
+  std::thread enrich_thread = run_stage(enrich, 2,
+                                        [&notional](Order const& order, uint64_t sequence)
+                                        { notional[sequence] = order.price * order.quantity; });
+
+  std::thread publish_thread = run_stage(publish, 3,
+                                         [&notional, &total_latency_ns](Order const& order, uint64_t sequence)
+                                         {
+                                           sq::bench::do_not_optimize(notional[sequence]);
+                                           total_latency_ns += sq::bench::now_ns() - order.created_ns;
+                                         });
+
+  sq::bench::pin_to_cpu(0);
+  uint64_t const start = sq::bench::now_ns();
+
+  for (uint64_t i = 0; i < messages; ++i)
+  {
+    producer.write(Order{i, i, i, sq::bench::now_ns(), {}});
+  }
+
+  decode_thread.join();
+  enrich_thread.join();
+  publish_thread.join();
+
+  uint64_t const elapsed = sq::bench::now_ns() - start;
+
+  sq::bench::report("pipeline, 3 stages in place", messages, elapsed);
+  std::printf("%-56s %10.2f ns/msg\n", "pipeline, 3 stages in place, end to end latency",
+              static_cast<double>(total_latency_ns) / static_cast<double>(messages));
+}
+
+/***/
+void run_chained_queues()
+{
+  queue_t first{capacity, false, 1};
+  queue_t second{capacity, false, 1};
+  queue_t third{capacity, false, 1};
+
+  sq::SeqlockQueueProducer<queue_t> producer{first, sq::WaitStrategy::Yield};
+
+  uint64_t total_latency_ns{0};
+
+  // each hop reads a copy of the message and writes it to the next queue
+  auto run_hop = [](queue_t& from, queue_t* to, unsigned cpu, auto callback)
+  {
+    return std::thread{[&from, to, cpu, callback]() mutable
+                       {
+                         sq::bench::pin_to_cpu(cpu);
+                         sq::SeqlockQueueConsumer<queue_t> consumer{from, sq::ConsumerMode::Lossless};
+                         std::unique_ptr<sq::SeqlockQueueProducer<queue_t>> next;
+                         if (to)
+                         {
+                           next = std::make_unique<sq::SeqlockQueueProducer<queue_t>>(*to, sq::WaitStrategy::Yield);
+                         }
+
+                         Order order;
+                         uint64_t received{0};
+                         while (received != messages)
+                         {
+                           if (!consumer.try_read(order))
+                           {
+                             std::this_thread::yield();
+                             continue;
+                           }
+
+                           callback(order);
+                           if (next)
+                           {
+                             next->write(order);
+                           }
+                           ++received;
+                         }
+                       }};
+  };
+
+  std::thread decode_thread = run_hop(first, &second, 1, [](Order& order) { sq::bench::do_not_optimize(order.id); });
+
+  std::thread enrich_thread =
+    run_hop(second, &third, 2, [](Order& order) { order.payload[0] = order.price * order.quantity; });
+
+  std::thread publish_thread = run_hop(third, nullptr, 3,
+                                       [&total_latency_ns](Order& order)
+                                       {
+                                         sq::bench::do_not_optimize(order.payload[0]);
+                                         total_latency_ns += sq::bench::now_ns() - order.created_ns;
+                                       });
+
+  sq::bench::pin_to_cpu(0);
+  uint64_t const start = sq::bench::now_ns();
+
+  for (uint64_t i = 0; i < messages; ++i)
+  {
+    producer.write(Order{i, i, i, sq::bench::now_ns(), {}});
+  }
+
+  decode_thread.join();
+  enrich_thread.join();
+  publish_thread.join();
+
+  uint64_t const elapsed = sq::bench::now_ns() - start;
+
+  sq::bench::report("pipeline, 3 chained queues", messages, elapsed);
+  std::printf("%-56s %10.2f ns/msg\n", "pipeline, 3 chained queues, end to end latency",
+              static_cast<double>(total_latency_ns) / static_cast<double>(messages));
+}
+} // namespace
+
+int main()
+{
+  run_pipeline();
+  run_chained_queues();
+  return 0;
+}
@@ -0,0 +1,175 @@
+#include "bench_utils.h"
+
+#include "seqlock_queue/poll_set.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * One thread reading 20 rings of which only one receives messages, comparing the poll set with a
+ * hand written round robin loop calling try_read on every ring. Single threaded, so the numbers
+ * are the cost of visiting the rings rather than of cache line transfers
+ */
+
+namespace
+{
+struct Quote
+{
+  uint64_t instrument;
+  uint64_t bid;
+  uint64_t ask;
+  uint64_t bid_size;
+  uint64_t ask_size;
+  uint64_t timestamp;
+};
+
+using queue_t = sq::BoundedSeqlockQueue<Quote>;
+
+constexpr size_t rings{20};
+constexpr size_t hot_ring{7};
+constexpr size_t capacity{1u << 12u};
+constexpr uint64_t messages{1u << 22u};
+constexpr uint64_t idle_polls{1u << 22u};
+
+/***/
+void run_hand_written(uint64_t burst)
+{
+  std::vector<std::unique_ptr<queue_t>> queues;
+  std::vector<std::unique_ptr<sq::SeqlockQueueConsumer<queue_t>>> consumers;
+
+  for (size_t i = 0; i < rings; ++i)
+  {
+    queues.push_back(std::make_unique<queue_t>(capacity));
+    consumers.push_back(std::make_unique<sq::SeqlockQueueConsumer<queue_t>>(*queues.back()));
+  }
+
+  sq::SeqlockQueueProducer<queue_t> producer{*queues[hot_ring]};
+
+  Quote quote;
+  uint64_t received{0};
+
+  uint64_t const start = sq::bench::now_ns();
+
+  for (uint64_t i = 0; i < messages; i += burst)
+  {
+    for (uint64_t j = 0; j < burst; ++j)
+    {
+      producer.write(Quote{hot_ring, i + j, i + j, 1, 1, i + j});
+    }
+
+    uint64_t const target = i + burst;
+    while (received != target)
+    {
+      for (auto& consumer : consumers)
+      {
+        if (consumer->try_read(quote))
+        {
+          sq::bench::do_not_optimize(quote);
+          ++received;
+        }
+      }
+    }
+  }
+
+  uint64_t const elapsed = sq::bench::now_ns() - start;
+
+  char name[64];
+  std::snprintf(name, sizeof(name), "hand written round robin, bursts of %lu", static_cast<unsigned long>(burst));
+  sq::bench::report(name, messages, elapsed);
+}
+
+/***/
+void run_poll_set(sq::PollPolicy policy, char const* policy_name, uint64_t burst)
+{
+  std::vector<std::unique_ptr<queue_t>> queues;
+  sq::SeqlockQueuePollSet<queue_t> poll_set{policy, 16};
+
+  for (size_t i = 0; i < rings; ++i)
+  {
+    queues.push_back(std::make_unique<queue_t>(capacity));
+    poll_set.add(*queues.back(), (i == hot_ring) ? 10 : 1);
+  }
+
+  sq::SeqlockQueueProducer<queue_t> producer{*queues[hot_ring]};
+
+  uint64_t received{0};
+  auto callback = [&received](size_t, Quote const& quote)
+  {
+    sq::bench::do_not_optimize(quote);
+    ++received;
+  };
+
+  uint64_t const start = sq::bench::now_ns();
+
+  for (uint64_t i = 0; i < messages; i += burst)
+  {
+    for (uint64_t j = 0; j < burst; ++j)
+    {
+      producer.write(Quote{hot_ring, i + j, i + j, 1, 1, i + j});
+    }
+
+    uint64_t const target = i + burst;
+    while (received != target)
+    {
+      poll_set.poll(callback);
+    }
+  }
+
+  uint64_t const elapsed = sq::bench::now_ns() - start;
+
+  char name[64];
+  std::snprintf(name, sizeof(name), "poll set %s, bursts of %lu", policy_name, static_cast<unsigned long>(burst));
+  sq::bench::report(name, messages, elapsed);
+}
+
+/**
+ * The cost of a pass over 20 rings without messages
+ */
+void run_idle()
+{
+  std::vector<std::unique_ptr<queue_t>> queues;
+  std::vector<std::unique_ptr<sq::SeqlockQueueConsumer<queue_t>>> consumers;
+  sq::SeqlockQueuePollSet<queue_t> poll_set;
+
+  for (size_t i = 0; i < rings; ++i)
+  {
+    queues.push_back(std::make_unique<queue_t>(capacity));
+    consumers.push_back(std::make_unique<sq::SeqlockQueueConsumer<queue_t>>(*queues.back()));
+    poll_set.add(*queues.back());
+  }
+
+  Quote quote;
+
+  uint64_t start = sq::bench::now_ns();
+  for (uint64_t i = 0; i < idle_polls; ++i)
+  {
+    for (auto& consumer : consumers)
+    {
+      sq::bench::do_not_optimize(consumer->try_read(quote));
+    }
+  }
+  sq::bench::report("idle pass, hand written round robin (ns/pass)", idle_polls, sq::bench::now_ns() - start);
+
+  start = sq::bench::now_ns();
+  for (uint64_t i = 0; i < idle_polls; ++i)
+  {
+    sq::bench::do_not_optimize(poll_set.poll([](size_t, Quote const&) {}));
+  }
+  sq::bench::report("idle pass, poll set (ns/pass)", idle_polls, sq::bench::now_ns() - start);
+}
+} // namespace
+
+int main()
+{
+  run_idle();
+
+  for (uint64_t burst : {1u, 16u, 64u})
+  {
+    run_hand_written(burst);
+    run_poll_set(sq::PollPolicy::RoundRobin, "round robin", burst);
+    run_poll_set(sq::PollPolicy::Priority, "priority", burst);
+    run_poll_set(sq::PollPolicy::Weighted, "weighted", burst);
+  }
+
+  return 0;
+}
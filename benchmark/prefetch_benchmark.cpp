@@ -0,0 +1,61 @@
+#include "bench_utils.h"
+
+/**
+ * Measures the producer and consumer prefetch policies per payload size and capacity
+ */
+
+namespace
+{
+template <size_t Size>
+struct Payload
+{
+  uint64_t sequence;
+  uint8_t bytes[Size - sizeof(uint64_t)];
+};
+
+/***/
+template <size_t Size, size_t PrefetchDistance, bool PrefetchNext>
+void run(size_t capacity)
+{
+  using queue_t = sq::BoundedSeqlockQueue<Payload<Size>>;
+  using producer_t = sq::SeqlockQueueProducer<queue_t, PrefetchDistance>;
+  using consumer_t = sq::SeqlockQueueConsumer<queue_t, PrefetchNext>;
+
+  auto make_value = [](uint64_t i)
+  {
+    Payload<Size> payload;
+    payload.sequence = i;
+    return payload;
+  };
+
+  char name[96];
+
+  std::snprintf(name, sizeof(name), "producer %4zuB cap %6zu distance %2zu", Size, capacity, PrefetchDistance);
+  sq::bench::run_producer_only<queue_t, producer_t>(name, capacity, 10'000'000, make_value);
+
+  std::snprintf(name, sizeof(name), "throughput %4zuB cap %6zu distance %2zu next %d", Size, capacity,
+                PrefetchDistance, PrefetchNext);
+  sq::bench::run_throughput<queue_t, producer_t, consumer_t>(name, capacity, 10'000'000, make_value);
+}
+
+/***/
+template <size_t Size>
+void run_size()
+{
+  for (size_t capacity : {1024u, 262144u})
+  {
+    run<Size, 0, false>(capacity);
+    run<Size, 4, false>(capacity);
+    run<Size, 16, false>(capacity);
+    run<Size, 16, true>(capacity);
+  }
+}
+} // namespace
+
+int main()
+{
+  run_size<64>();
+  run_size<512>();
+
+  return 0;
+}
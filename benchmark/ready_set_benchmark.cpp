@@ -0,0 +1,195 @@
+#include "bench_utils.h"
+
+#include "seqlock_queue/ready_set.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+/**
+ * 8192 rings of which 1% receive a message between two polls. Compares a consumer that checks every
+ * ring with one that only visits the rings reported by a ReadySet, and measures what marking the
+ * ready set adds to a write. Single threaded
+ */
+
+namespace
+{
+struct Quote
+{
+  uint64_t instrument;
+  uint64_t bid;
+  uint64_t ask;
+  uint64_t bid_size;
+  uint64_t ask_size;
+  uint64_t timestamp;
+};
+
+using queue_t = sq::BoundedSeqlockQueue<Quote>;
+using producer_t = sq::SeqlockQueueProducer<queue_t>;
+using consumer_t = sq::SeqlockQueueConsumer<queue_t>;
+
+constexpr size_t rings{8192};
+constexpr size_t active_rings{rings / 100};
+constexpr size_t capacity{16};
+constexpr uint64_t rounds{20'000};
+
+struct Rings
+{
+  explicit Rings(sq::ReadySet* ready_set)
+  {
+    for (size_t i = 0; i < rings; ++i)
+    {
+      queues.push_back(std::make_unique<queue_t>(capacity));
+      producers.push_back(std::make_unique<producer_t>(*queues.back()));
+      consumers.push_back(std::make_unique<consumer_t>(*queues.back()));
+
+      if (ready_set)
+      {
+        producers.back()->set_ready_set(*ready_set, i);
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<queue_t>> queues;
+  std::vector<std::unique_ptr<producer_t>> producers;
+  std::vector<std::unique_ptr<consumer_t>> consumers;
+};
+
+/**
+ * The rings written in each round
+ */
+std::vector<size_t> make_activity()
+{
+  std::mt19937_64 generator{42};
+  std::uniform_int_distribution<size_t> distribution{0, rings - 1};
+
+  std::vector<size_t> activity(rounds * active_rings);
+  for (size_t& ring : activity)
+  {
+    ring = distribution(generator);
+  }
+
+  return activity;
+}
+
+/***/
+void run_scan_all(std::vector<size_t> const& activity)
+{
+  Rings state{nullptr};
+  Quote quote;
+  uint64_t received{0};
+  uint64_t elapsed{0};
+
+  for (uint64_t round = 0; round < rounds; ++round)
+  {
+    for (size_t i = 0; i < active_rings; ++i)
+    {
+      size_t const ring = activity[round * active_rings + i];
+      state.producers[ring]->write(Quote{ring, round, round, 1, 1, round});
+    }
+
+    uint64_t const start = sq::bench::now_ns();
+
+    for (auto& consumer : state.consumers)
+    {
+      while (!consumer->empty() && consumer->try_read(quote))
+      {
+        sq::bench::do_not_optimize(quote);
+        ++received;
+      }
+    }
+
+    elapsed += sq::bench::now_ns() - start;
+  }
+
+  sq::bench::do_not_optimize(received);
+  sq::bench::report("poll every ring (ns/poll)", rounds, elapsed);
+}
+
+/***/
+void run_ready_set(std::vector<size_t> const& activity)
+{
+  sq::ReadySet ready_set{rings};
+  Rings state{&ready_set};
+  Quote quote;
+  uint64_t received{0};
+  uint64_t elapsed{0};
+
+  for (uint64_t round = 0; round < rounds; ++round)
+  {
+    for (size_t i = 0; i < active_rings; ++i)
+    {
+      size_t const ring = activity[round * active_rings + i];
+      state.producers[ring]->write(Quote{ring, round, round, 1, 1, round});
+    }
+
+    uint64_t const start = sq::bench::now_ns();
+
+    ready_set.poll(
+      [&state, &quote, &received](size_t ring)
+      {
+        while (state.consumers[ring]->try_read(quote))
+        {
+          sq::bench::do_not_optimize(quote);
+          ++received;
+        }
+      });
+
+    elapsed += sq::bench::now_ns() - start;
+  }
+
+  sq::bench::do_not_optimize(received);
+  sq::bench::report("poll the ready set (ns/poll)", rounds, elapsed);
+}
+
+/**
+ * The cost of a write to one hot ring, without a ready set, with the bit still set from the last
+ * write and with the bit cleared by the consumer after every write
+ */
+void run_producer_overhead()
+{
+  constexpr uint64_t messages{1u << 22u};
+
+  sq::ReadySet ready_set{rings};
+
+  for (int mode = 0; mode < 3; ++mode)
+  {
+    queue_t queue{1024};
+    producer_t producer{queue};
+
+    if (mode != 0)
+    {
+      producer.set_ready_set(ready_set, 4000);
+    }
+
+    uint64_t const start = sq::bench::now_ns();
+
+    for (uint64_t i = 0; i < messages; ++i)
+    {
+      producer.write(Quote{i, i, i, 1, 1, i});
+
+      if (mode == 2)
+      {
+        ready_set.poll([](size_t ring) { sq::bench::do_not_optimize(ring); });
+      }
+    }
+
+    uint64_t const elapsed = sq::bench::now_ns() - start;
+
+    char const* names[3]{"write without a ready set", "write, ready bit already set",
+                         "write, ready bit cleared every time, incl. the poll"};
+    sq::bench::report(names[mode], messages, elapsed);
+  }
+}
+} // namespace
+
+int main()
+{
+  std::vector<size_t> const activity = make_activity();
+
+  run_scan_all(activity);
+  run_ready_set(activity);
+  run_producer_overhead();
+
+  return 0;
+}
@@ -0,0 +1,74 @@
+#include "bench_utils.h"
+
+#include <vector>
+
+/**
+ * Positions a consumer at a time in a full 1M slot ring with seek_timestamp, against reading from
+ * the oldest message until the time is reached
+ */
+
+namespace
+{
+struct Tick
+{
+  uint64_t sequence;
+  uint64_t price;
+  uint64_t quantity;
+};
+
+using queue_t = sq::BoundedSeqlockQueue<Tick, 64, 64, false, true>;
+
+constexpr size_t capacity{1u << 20u};
+constexpr uint32_t searches{1000};
+} // namespace
+
+int main()
+{
+  queue_t queue{capacity};
+  sq::SeqlockQueueProducer<queue_t> producer{queue};
+
+  // one and a half laps
+  std::vector<uint64_t> times;
+  for (uint64_t i = 0; i < capacity + capacity / 2; ++i)
+  {
+    if (i % 1024 == 0)
+    {
+      times.push_back(sq::detail::steady_clock_ns());
+    }
+
+    producer.write(Tick{i, i, i});
+  }
+
+  sq::SeqlockQueueConsumer<queue_t> consumer{queue};
+
+  uint64_t start = sq::bench::now_ns();
+  for (uint32_t i = 0; i < searches; ++i)
+  {
+    consumer.seek_timestamp(times[(i * 7919u) % times.size()]);
+    sq::bench::do_not_optimize(consumer.sequence());
+  }
+  sq::bench::report("seek_timestamp in a 1M slot ring", searches, sq::bench::now_ns() - start);
+
+  // the linear alternative, reading from the oldest message until the time is reached
+  Tick result;
+  start = sq::bench::now_ns();
+  for (uint32_t i = 0; i < searches / 100; ++i)
+  {
+    uint64_t const target = times[(i * 7919u) % times.size()];
+    consumer.seek(sq::StartPosition::oldest());
+
+    while (consumer.try_read(result))
+    {
+      sq::bench::do_not_optimize(result);
+
+      // the value does not carry the time, stop at the sequence the seek would find
+      if ((result.sequence % 1024 == 0) && (times[result.sequence / 1024] >= target))
+      {
+        break;
+      }
+    }
+  }
+  sq::bench::report("linear scan with try_read in a 1M slot ring", searches / 100, sq::bench::now_ns() - start);
+
+  return 0;
+}
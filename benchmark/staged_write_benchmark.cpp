@@ -0,0 +1,107 @@
+#define SEQLOCK_QUEUE_INSTRUMENTATION
+
+#include "bench_utils.h"
+
+/**
+ * Compares write(callback) with write_staged(callback) for a callback that builds a 1 KB
+ * snapshot. Reports how long the slots stay locked and how often the consumer sees a torn read.
+ */
+
+namespace
+{
+struct Snapshot
+{
+  uint64_t sequence;
+  uint64_t levels[127];
+};
+
+using queue_t = sq::BoundedSeqlockQueue<Snapshot>;
+
+/***/
+void build_snapshot(Snapshot& snapshot, uint64_t sequence) noexcept
+{
+  snapshot.sequence = sequence;
+
+  uint64_t level = sequence;
+  for (uint64_t& l : snapshot.levels)
+  {
+    // stands in for the work done by a real callback
+    level = level * 6364136223846793005ull + 1442695040888963407ull;
+    l = level;
+  }
+}
+
+/***/
+template <bool Staged>
+void run(char const* name)
+{
+  constexpr size_t capacity{64};
+  constexpr uint64_t messages{2'000'000};
+
+  queue_t queue{capacity};
+  sq::SeqlockQueueProducer<queue_t> producer{queue};
+
+  std::atomic<bool> consumer_ready{false};
+  std::atomic<bool> producer_done{false};
+  sq::ConsumerStats consumer_stats;
+
+  std::thread consumer_thread{[&]()
+                              {
+                                sq::bench::pin_to_cpu(1);
+                                sq::SeqlockQueueConsumer<queue_t> consumer{queue};
+                                Snapshot result;
+
+                                consumer_ready.store(true);
+
+                                while (!producer_done.load(std::memory_order_relaxed))
+                                {
+                                  consumer.try_read(result);
+                                  sq::bench::do_not_optimize(result);
+                                }
+
+                                consumer_stats = consumer.stats();
+                              }};
+
+  sq::bench::pin_to_cpu(0);
+
+  while (!consumer_ready.load())
+  {
+    std::this_thread::yield();
+  }
+
+  uint64_t const start = sq::bench::now_ns();
+  for (uint64_t i = 0; i < messages; ++i)
+  {
+    if constexpr (Staged)
+    {
+      producer.write_staged([i](Snapshot& snapshot) { build_snapshot(snapshot, i); });
+    }
+    else
+    {
+      producer.write([i](Snapshot& snapshot) { build_snapshot(snapshot, i); });
+    }
+  }
+  uint64_t const elapsed = sq::bench::now_ns() - start;
+
+  producer_done.store(true);
+  consumer_thread.join();
+
+  sq::ProducerStats const& producer_stats = producer.stats();
+
+  sq::bench::report(name, messages, elapsed);
+  std::printf("%-56s %10.1f avg locked ticks %10llu max locked ticks\n", "",
+              static_cast<double>(producer_stats.locked_ticks) / static_cast<double>(producer_stats.writes),
+              static_cast<unsigned long long>(producer_stats.max_locked_ticks));
+  std::printf("%-56s %10llu reads %10llu torn reads\n", "",
+              static_cast<unsigned long long>(consumer_stats.reads),
+              static_cast<unsigned long long>(consumer_stats.torn_reads));
+}
+} // namespace
+
+int main()
+{
+  run<false>("write(callback)");
+  run<true>("write_staged(callback)");
+
+  return 0;
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "seqlock_queue/seqlock_queue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+namespace sq
+{
+/**
+ * The shared state of a group of consumers that split the messages of a queue between them, each
+ * message is read by exactly one member
+ */
+class ConsumerGroup
+{
+public:
+  ConsumerGroup(ConsumerGroup const&) = delete;
+  ConsumerGroup& operator=(ConsumerGroup const&) = delete;
+  ConsumerGroup(ConsumerGroup&&) = delete;
+  ConsumerGroup& operator=(ConsumerGroup&&) = delete;
+
+  /**
+   * @param bounded_seqlock_queue the queue the members read
+   * @param start_position where the group starts reading, by default the messages written from now
+   * on, like the members
+   */
+  template <typename TBoundedSeqlockQueue>
+  explicit ConsumerGroup(TBoundedSeqlockQueue& bounded_seqlock_queue,
+                         StartPosition start_position = StartPosition::latest())
+    : _claim_sequence(SeqlockQueueConsumer<TBoundedSeqlockQueue>{bounded_seqlock_queue, ConsumerMode::Lossy,
+                                                                 start_position}
+                        .sequence())
+  {
+  }
+
+  /**
+   * @param first_sequence the first message the group reads
+   */
+  explicit ConsumerGroup(uint64_t first_sequence) : _claim_sequence(first_sequence) {}
+
+  /**
+   * @return the number of messages that were claimed by a member but overwritten by the producer
+   * before the member could read them
+   */
+  uint64_t overwritten_claims() const noexcept { return _overwritten_claims.load(std::memory_order_relaxed); }
+
+  /**
+   * @return the number of messages the group did not read because the producer overwrote them,
+   * the overwritten claims and the messages the group skipped after them without claiming
+   */
+  uint64_t lost_messages() const noexcept { return _lost_messages.load(std::memory_order_relaxed); }
+
+  template <typename>
+  friend class SeqlockQueueGroupConsumer;
+
+private:
+  // The next message to be claimed, the members take turns with fetch_add
+  alignas(detail::CACHE_ALIGNED) std::atomic<uint64_t> _claim_sequence{0};
+  alignas(detail::CACHE_ALIGNED) std::atomic<uint64_t> _overwritten_claims{0};
+  std::atomic<uint64_t> _lost_messages{0};
+};
+
+/**
+ * A member of a ConsumerGroup. Claims the next message of the group and then reads it with the
+ * seqlock protocol. A member holds at most one claim, which only it can read, so members must
+ * keep polling while the group is in use.
+ */
+template <typename TBoundedSeqlockQueue>
+class SeqlockQueueGroupConsumer
+{
+public:
+  using value_t = typename TBoundedSeqlockQueue::value_t;
+
+  SeqlockQueueGroupConsumer(SeqlockQueueGroupConsumer const&) = delete;
+  SeqlockQueueGroupConsumer& operator=(SeqlockQueueGroupConsumer const&) = delete;
+  SeqlockQueueGroupConsumer(SeqlockQueueGroupConsumer&&) = delete;
+  SeqlockQueueGroupConsumer& operator=(SeqlockQueueGroupConsumer&&) = delete;
+
+  /**
+   * @param bounded_seqlock_queue
+   * @param consumer_group
+   */
+  SeqlockQueueGroupConsumer(TBoundedSeqlockQueue& bounded_seqlock_queue, ConsumerGroup& consumer_group)
+    : _consumer(bounded_seqlock_queue, ConsumerMode::Lossy, StartPosition::latest()), _group(&consumer_group)
+  {
+  }
+
+  /**
+   * Non blocking read of the next message of the group.
+   * @param result
+   * @return Success, Empty or Busy when the claimed message is not published yet, or Overwritten
+   * when the producer overwrote the claimed message before it was read. The group then continues
+   * from the oldest message in the queue.
+   */
+  ReadResult try_read(value_t& result) noexcept
+  {
+    if (_claimed == no_claim)
+    {
+      // Only claim once the next message is published, so that idle members do not hold claims
+      uint64_t const next = _group->_claim_sequence.load(std::memory_order_relaxed);
+      ReadResult const next_result = _consumer.try_get(next, result);
+
+      if ((next_result == ReadResult::Empty) || (next_result == ReadResult::Busy))
+      {
+        return next_result;
+      }
+
+      _claimed = _group->_claim_sequence.fetch_add(1, std::memory_order_relaxed);
+
+      if ((_claimed == next) && (next_result == ReadResult::Success))
+      {
+        // The message was read before it was claimed
+        _claimed = no_claim;
+        return ReadResult::Success;
+      }
+    }
+
+    ReadResult const read_result = _consumer.try_get(_claimed, result);
+
+    if (read_result == ReadResult::Success)
+    {
+      _claimed = no_claim;
+    }
+    else if (read_result == ReadResult::Overwritten)
+    {
+      _claimed = no_claim;
+      _group->_overwritten_claims.fetch_add(1, std::memory_order_relaxed);
+      _group->_lost_messages.fetch_add(1, std::memory_order_relaxed);
+      skip_overwritten();
+    }
+
+    return read_result;
+  }
+
+private:
+  /**
+   * Moves the claim sequence of the group to the oldest message in the queue, so that the members
+   * do not have to claim every overwritten message one by one. The member that moves it counts
+   * the skipped messages as lost.
+   */
+  void skip_overwritten() noexcept
+  {
+    _consumer.seek(StartPosition::oldest());
+    uint64_t const oldest = _consumer.sequence();
+
+    uint64_t claim_sequence = _group->_claim_sequence.load(std::memory_order_relaxed);
+    while (claim_sequence < oldest)
+    {
+      if (_group->_claim_sequence.compare_exchange_weak(claim_sequence, oldest, std::memory_order_relaxed))
+      {
+        _group->_lost_messages.fetch_add(oldest - claim_sequence, std::memory_order_relaxed);
+        return;
+      }
+    }
+  }
+
+private:
+  static constexpr uint64_t no_claim = std::numeric_limits<uint64_t>::max();
+
+  SeqlockQueueConsumer<TBoundedSeqlockQueue> _consumer;
+  ConsumerGroup* _group{nullptr};
+  uint64_t _claimed{no_claim};
+};
+} // namespace sq
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "seqlock_queue/seqlock_queue.h"
+
+// Requires C++20 coroutines, the header is empty otherwise
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+  #include <coroutine>
+  #include <cstdint>
+  #include <utility>
+  #include <vector>
+
+namespace sq
+{
+/**
+ * Resumes the coroutines suspended in co_await consumer.next() once their queues have a message.
+ * One poller serves all the awaitable consumers of an executor thread, which calls poll() from its
+ * loop, so many low rate subscriptions share one polling thread. A poller and its consumers must
+ * only be used from that thread.
+ */
+class SeqlockQueuePoller
+{
+public:
+  SeqlockQueuePoller(SeqlockQueuePoller const&) = delete;
+  SeqlockQueuePoller& operator=(SeqlockQueuePoller const&) = delete;
+  SeqlockQueuePoller(SeqlockQueuePoller&&) = delete;
+  SeqlockQueuePoller& operator=(SeqlockQueuePoller&&) = delete;
+
+  SeqlockQueuePoller() = default;
+
+  /**
+   * Checks every suspended consumer once and resumes the ones that read a message. Coroutines
+   * that suspend again while they run are checked by the next poll. A resumed coroutine may call
+   * poll itself or destroy other consumers, whose coroutines are then not resumed.
+   * @return the number of coroutines resumed
+   */
+  size_t poll()
+  {
+    // The coroutines are resumed after the pass, so that they can suspend again without
+    // changing the waiters while they are being checked
+    Resuming resuming{{}, _resuming};
+    resuming.waiters.swap(_spare);
+    resuming.waiters.clear();
+
+    size_t i{0};
+    while (i < _waiters.size())
+    {
+      if (_waiters[i].try_complete(_waiters[i].awaiter))
+      {
+        resuming.waiters.push_back(_waiters[i]);
+        _waiters[i] = _waiters.back();
+        _waiters.pop_back();
+      }
+      else
+      {
+        ++i;
+      }
+    }
+
+    // Registered while resuming, so that cancel can find the coroutines not resumed yet
+    ResumingScope const scope{*this, resuming};
+
+    size_t resumed{0};
+    for (size_t j = 0; j < resuming.waiters.size(); ++j)
+    {
+      if (std::coroutine_handle<> const handle = resuming.waiters[j].handle)
+      {
+        ++resumed;
+        handle.resume();
+      }
+    }
+
+    return resumed;
+  }
+
+  /**
+   * @return the number of suspended coroutines
+   */
+  size_t waiting() const noexcept { return _waiters.size(); }
+
+  /**
+   * Registers a suspended coroutine, used by the awaitables
+   * @param awaiter passed to try_complete
+   * @param try_complete reads the message for the awaiter and returns true once there is one
+   * @param handle resumed after try_complete returned true
+   */
+  void suspend(void* awaiter, bool (*try_complete)(void*) noexcept, std::coroutine_handle<> handle)
+  {
+    _waiters.push_back(Waiter{awaiter, try_complete, handle});
+  }
+
+  /**
+   * Forgets the suspended coroutine of the awaiter, which is not resumed, also when a poll that is
+   * resuming coroutines has already read its message
+   */
+  void cancel(void* awaiter) noexcept
+  {
+    for (size_t i = 0; i < _waiters.size(); ++i)
+    {
+      if (_waiters[i].awaiter == awaiter)
+      {
+        _waiters[i] = _waiters.back();
+        _waiters.pop_back();
+        break;
+      }
+    }
+
+    for (Resuming* resuming = _resuming; resuming; resuming = resuming->outer)
+    {
+      for (Waiter& waiter : resuming->waiters)
+      {
+        if (waiter.awaiter == awaiter)
+        {
+          waiter.handle = nullptr;
+        }
+      }
+    }
+  }
+
+private:
+  struct Waiter
+  {
+    void* awaiter;
+    bool (*try_complete)(void*) noexcept;
+    std::coroutine_handle<> handle;
+  };
+
+  /**
+   * The coroutines a poll is resuming, and those of the poll it is nested in
+   */
+  struct Resuming
+  {
+    std::vector<Waiter> waiters;
+    Resuming* outer;
+  };
+
+  struct ResumingScope
+  {
+    ResumingScope(SeqlockQueuePoller& poller, Resuming& resuming) noexcept : poller(poller), resuming(resuming)
+    {
+      poller._resuming = &resuming;
+    }
+
+    ~ResumingScope()
+    {
+      poller._resuming = resuming.outer;
+
+      // Keeps the allocation for the next poll
+      poller._spare.swap(resuming.waiters);
+    }
+
+    SeqlockQueuePoller& poller;
+    Resuming& resuming;
+  };
+
+  std::vector<Waiter> _waiters;
+  std::vector<Waiter> _spare;
+  Resuming* _resuming{nullptr};
+};
+
+/**
+ * A consumer for coroutines, `value_t value = co_await consumer.next();` completes without
+ * suspending when the queue has a message and otherwise suspends until the poller finds one.
+ * A consumer can have one pending next() at a time, destroying the consumer cancels it.
+ */
+template <typename TBoundedSeqlockQueue>
+class SeqlockQueueAwaitableConsumer
+{
+public:
+  using value_t = typename TBoundedSeqlockQueue::value_t;
+
+  SeqlockQueueAwaitableConsumer(SeqlockQueueAwaitableConsumer const&) = delete;
+  SeqlockQueueAwaitableConsumer& operator=(SeqlockQueueAwaitableConsumer const&) = delete;
+  SeqlockQueueAwaitableConsumer(SeqlockQueueAwaitableConsumer&&) = delete;
+  SeqlockQueueAwaitableConsumer& operator=(SeqlockQueueAwaitableConsumer&&) = delete;
+
+  /**
+   * @param bounded_seqlock_queue
+   * @param poller of the executor thread the coroutines run on
+   * @param mode
+   * @param start_position
+   */
+  SeqlockQueueAwaitableConsumer(TBoundedSeqlockQueue& bounded_seqlock_queue, SeqlockQueuePoller& poller,
+                                ConsumerMode mode = ConsumerMode::Lossy,
+                                StartPosition start_position = StartPosition::oldest())
+    : _consumer(bounded_seqlock_queue, mode, start_position), _poller(poller)
+  {
+  }
+
+  ~SeqlockQueueAwaitableConsumer() { _poller.cancel(this); }
+
+  class NextAwaitable
+  {
+  public:
+    explicit NextAwaitable(SeqlockQueueAwaitableConsumer& consumer) noexcept : _consumer(consumer) {}
+
+    bool await_ready() noexcept { return _consumer._consumer.try_read(_consumer._value); }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+      _consumer._poller.suspend(&_consumer, &SeqlockQueueAwaitableConsumer::try_complete, handle);
+    }
+
+    value_t await_resume() noexcept { return _consumer._value; }
+
+  private:
+    SeqlockQueueAwaitableConsumer& _consumer;
+  };
+
+  /**
+   * @return an awaitable returning the next message
+   */
+  NextAwaitable next() noexcept { return NextAwaitable{*this}; }
+
+  /**
+   * @return the consumer, e.g. for try_read outside of a coroutine
+   */
+  SeqlockQueueConsumer<TBoundedSeqlockQueue>& consumer() noexcept { return _consumer; }
+
+private:
+  static bool try_complete(void* awaiter) noexcept
+  {
+    auto* consumer = static_cast<SeqlockQueueAwaitableConsumer*>(awaiter);
+    return consumer->_consumer.try_read(consumer->_value);
+  }
+
+private:
+  SeqlockQueueConsumer<TBoundedSeqlockQueue> _consumer;
+  SeqlockQueuePoller& _poller;
+  value_t _value{};
+};
+} // namespace sq
+
+#endif
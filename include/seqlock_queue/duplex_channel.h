@@ -0,0 +1,293 @@
+#pragma once
+
+#include "seqlock_queue/seqlock_queue.h"
+
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <utility>
+
+namespace sq
+{
+/**
+ * A message of a DuplexChannel, a response carries the correlation id of its request
+ */
+template <typename T>
+struct CorrelatedMessage
+{
+  uint64_t correlation_id;
+  T value;
+};
+
+/**
+ * A request ring and a response ring between one client and one server, e.g. a strategy and an
+ * order gateway. Both rings are lossless, a request or response is never overwritten before it is
+ * read. The two queues are on separate cache lines and their slots in separate allocations, so
+ * the two directions never share a cache line.
+ *
+ * Because both rings are lossless, send() waits while the server has not read the request ring
+ * and reply() waits while the client has not read the response ring. A client that sends without
+ * draining its responses can therefore block against a server blocked in reply(). Such a client
+ * should use try_send() and read responses when it fails, or the server try_reply().
+ */
+template <typename TRequest, typename TResponse, size_t SlotAlignment = detail::CACHE_ALIGNED,
+          size_t CacheAligned = detail::CACHE_ALIGNED>
+class DuplexChannel
+{
+public:
+  using request_queue_t = BoundedSeqlockQueue<CorrelatedMessage<TRequest>, SlotAlignment, CacheAligned>;
+  using response_queue_t = BoundedSeqlockQueue<CorrelatedMessage<TResponse>, SlotAlignment, CacheAligned>;
+
+  DuplexChannel(DuplexChannel const&) = delete;
+  DuplexChannel& operator=(DuplexChannel const&) = delete;
+  DuplexChannel(DuplexChannel&&) = delete;
+  DuplexChannel& operator=(DuplexChannel&&) = delete;
+
+  /**
+   * @param capacity of each direction
+   * @param huge_pages
+   */
+  explicit DuplexChannel(size_t capacity, bool huge_pages = false)
+    : _requests(capacity, huge_pages, 1), _responses(capacity, huge_pages, 1)
+  {
+  }
+
+  /***/
+  request_queue_t& requests() noexcept { return _requests; }
+
+  /***/
+  response_queue_t& responses() noexcept { return _responses; }
+
+private:
+  alignas(detail::CACHE_ALIGNED) request_queue_t _requests;
+  alignas(detail::CACHE_ALIGNED) response_queue_t _responses;
+};
+
+/**
+ * The client end of a DuplexChannel, sends requests and receives their responses. Only one
+ * client may use a channel.
+ */
+template <typename TDuplexChannel>
+class DuplexChannelClient
+{
+public:
+  using request_t = decltype(std::declval<typename TDuplexChannel::request_queue_t::value_t>().value);
+  using response_t = decltype(std::declval<typename TDuplexChannel::response_queue_t::value_t>().value);
+
+  DuplexChannelClient(DuplexChannelClient const&) = delete;
+  DuplexChannelClient& operator=(DuplexChannelClient const&) = delete;
+  DuplexChannelClient(DuplexChannelClient&&) = delete;
+  DuplexChannelClient& operator=(DuplexChannelClient&&) = delete;
+
+  /**
+   * @param channel
+   * @param wait_strategy how call() waits for the response and send() for room in the request ring
+   */
+  explicit DuplexChannelClient(TDuplexChannel& channel, WaitStrategy wait_strategy = WaitStrategy::Spin)
+    : _producer(channel.requests(), wait_strategy),
+      _consumer(channel.responses(), ConsumerMode::Lossless),
+      _wait_strategy(wait_strategy)
+  {
+  }
+
+  /**
+   * Sends a request without waiting for its response. Waits while the request ring is full, see
+   * DuplexChannel.
+   * @param request
+   * @return the correlation id of the request, its response carries the same id
+   */
+  uint64_t send(request_t const& request) noexcept
+  {
+    uint64_t const correlation_id = _next_correlation_id++;
+
+    _producer.write(
+      [correlation_id, &request](auto& message)
+      {
+        message.correlation_id = correlation_id;
+        message.value = request;
+      });
+
+    return correlation_id;
+  }
+
+  /**
+   * Like send(), but fails instead of waiting when the request ring is full.
+   * @param request
+   * @param correlation_id the correlation id of the request when it was sent
+   * @return true if sent, false if the request ring is full
+   */
+  bool try_send(request_t const& request, uint64_t& correlation_id) noexcept
+  {
+    bool const sent = _producer.try_write(
+      [id = _next_correlation_id, &request](auto& message)
+      {
+        message.correlation_id = id;
+        message.value = request;
+      });
+
+    if (sent)
+    {
+      correlation_id = _next_correlation_id++;
+    }
+
+    return sent;
+  }
+
+  /**
+   * Non blocking read of the next response.
+   * @param correlation_id the id of the request of the response
+   * @param response
+   * @return true if a response was read, false otherwise
+   */
+  bool try_receive(uint64_t& correlation_id, response_t& response) noexcept
+  {
+    if (!_consumer.try_read(_message))
+    {
+      return false;
+    }
+
+    correlation_id = _message.correlation_id;
+    response = _message.value;
+    return true;
+  }
+
+  /**
+   * Sends a request and waits for its response. Responses to earlier requests that arrive first
+   * are dropped, also while waiting for room in the request ring, so that the server is never left
+   * blocked in reply().
+   * @param request
+   * @param response
+   * @param timeout_ns how long to wait for the response
+   * @return true when the response arrived, false on timeout
+   */
+  bool call(request_t const& request, response_t& response,
+            uint64_t timeout_ns = std::numeric_limits<uint64_t>::max()) noexcept
+  {
+    uint64_t correlation_id;
+    while (!try_send(request, correlation_id))
+    {
+      _consumer.try_read(_message);
+      wait();
+    }
+
+    uint64_t const start = (timeout_ns == std::numeric_limits<uint64_t>::max()) ? 0 : detail::steady_clock_ns();
+
+    for (uint32_t attempt = 1;; ++attempt)
+    {
+      if (_consumer.try_read(_message) && (_message.correlation_id == correlation_id))
+      {
+        response = _message.value;
+        return true;
+      }
+
+      // The clock is only read every 64 attempts to keep the response latency low
+      if (start && ((attempt % 64) == 0) && (detail::steady_clock_ns() - start >= timeout_ns))
+      {
+        return false;
+      }
+
+      wait();
+    }
+  }
+
+private:
+  void wait() const noexcept
+  {
+    if (_wait_strategy == WaitStrategy::Yield)
+    {
+      std::this_thread::yield();
+    }
+    else
+    {
+      detail::cpu_pause();
+    }
+  }
+
+private:
+  SeqlockQueueProducer<typename TDuplexChannel::request_queue_t> _producer;
+  SeqlockQueueConsumer<typename TDuplexChannel::response_queue_t> _consumer;
+  typename TDuplexChannel::response_queue_t::value_t _message{};
+  uint64_t _next_correlation_id{1};
+  WaitStrategy _wait_strategy;
+};
+
+/**
+ * The server end of a DuplexChannel, receives requests and sends responses. Only one server may
+ * use a channel.
+ */
+template <typename TDuplexChannel>
+class DuplexChannelServer
+{
+public:
+  using request_t = typename DuplexChannelClient<TDuplexChannel>::request_t;
+  using response_t = typename DuplexChannelClient<TDuplexChannel>::response_t;
+
+  DuplexChannelServer(DuplexChannelServer const&) = delete;
+  DuplexChannelServer& operator=(DuplexChannelServer const&) = delete;
+  DuplexChannelServer(DuplexChannelServer&&) = delete;
+  DuplexChannelServer& operator=(DuplexChannelServer&&) = delete;
+
+  /**
+   * @param channel
+   * @param wait_strategy how reply() waits for room in the response ring
+   */
+  explicit DuplexChannelServer(TDuplexChannel& channel, WaitStrategy wait_strategy = WaitStrategy::Spin)
+    : _producer(channel.responses(), wait_strategy), _consumer(channel.requests(), ConsumerMode::Lossless)
+  {
+  }
+
+  /**
+   * Non blocking read of the next request.
+   * @param correlation_id to pass to reply()
+   * @param request
+   * @return true if a request was read, false otherwise
+   */
+  bool try_receive(uint64_t& correlation_id, request_t& request) noexcept
+  {
+    if (!_consumer.try_read(_message))
+    {
+      return false;
+    }
+
+    correlation_id = _message.correlation_id;
+    request = _message.value;
+    return true;
+  }
+
+  /**
+   * Sends the response to a request. Waits while the response ring is full, see DuplexChannel.
+   * @param correlation_id as received with the request
+   * @param response
+   */
+  void reply(uint64_t correlation_id, response_t const& response) noexcept
+  {
+    _producer.write(
+      [correlation_id, &response](auto& message)
+      {
+        message.correlation_id = correlation_id;
+        message.value = response;
+      });
+  }
+
+  /**
+   * Like reply(), but fails instead of waiting when the response ring is full.
+   * @param correlation_id as received with the request
+   * @param response
+   * @return true if sent, false if the response ring is full
+   */
+  bool try_reply(uint64_t correlation_id, response_t const& response) noexcept
+  {
+    return _producer.try_write(
+      [correlation_id, &response](auto& message)
+      {
+        message.correlation_id = correlation_id;
+        message.value = response;
+      });
+  }
+
+private:
+  SeqlockQueueProducer<typename TDuplexChannel::response_queue_t> _producer;
+  SeqlockQueueConsumer<typename TDuplexChannel::request_queue_t> _consumer;
+  typename TDuplexChannel::request_queue_t::value_t _message{};
+};
+} // namespace sq
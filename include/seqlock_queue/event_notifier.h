@@ -0,0 +1,153 @@
+#pragma once
+
+#include "seqlock_queue/seqlock_queue.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__)
+  #include <linux/membarrier.h>
+  #include <sys/eventfd.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+namespace sq
+{
+/**
+ * Wakes a consumer that waits in an event loop, e.g. with epoll, through an eventfd. The consumer
+ * arms the notifier before it waits on fd() and the producers attached with
+ * SeqlockQueueProducer::set_notifier write to the eventfd after their next message. While the
+ * notifier is not armed a write only costs a relaxed load of the armed flag.
+ *
+ * The usual loop of the consumer is:
+ *   read the queues until they are empty
+ *   if (notifier.arm(consumer)) wait for fd() to become readable, then notifier.acknowledge()
+ *
+ * Only available on linux.
+ */
+class EventNotifier
+{
+public:
+  EventNotifier(EventNotifier const&) = delete;
+  EventNotifier& operator=(EventNotifier const&) = delete;
+  EventNotifier(EventNotifier&&) = delete;
+  EventNotifier& operator=(EventNotifier&&) = delete;
+
+  /***/
+  EventNotifier()
+  {
+#if defined(__linux__)
+    _fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (_fd == -1)
+    {
+      throw std::runtime_error{std::string{"eventfd failed with errno "} + std::to_string(errno)};
+    }
+
+    // With process wide barriers from arm() the producers only need a compiler fence
+    _process_barrier =
+      ::syscall(__NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) == 0;
+#else
+    throw std::runtime_error{"EventNotifier is only supported on linux"};
+#endif
+  }
+
+  ~EventNotifier()
+  {
+#if defined(__linux__)
+    ::close(_fd);
+#endif
+  }
+
+  /**
+   * @return the eventfd, readable once a producer wrote after arm()
+   */
+  int fd() const noexcept { return _fd; }
+
+  /**
+   * Arms the notifier unless one of the consumers has a message, in which case the caller should
+   * read it instead of waiting.
+   * @param consumers SeqlockQueueConsumers of the queues of the attached producers
+   * @return true when armed and the caller can wait on fd()
+   */
+  template <typename... TConsumers>
+  bool arm(TConsumers const&... consumers) noexcept
+  {
+    _armed.store(1, std::memory_order_relaxed);
+    barrier();
+
+    // A message written before the producer could see the flag is found here
+    if (!(consumers.empty() && ...))
+    {
+      _armed.store(0, std::memory_order_relaxed);
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Resets the eventfd after it became readable, and disarms the notifier if no producer did.
+   */
+  void acknowledge() noexcept
+  {
+    _armed.store(0, std::memory_order_relaxed);
+
+#if defined(__linux__)
+    uint64_t value;
+    [[maybe_unused]] ssize_t const result = ::read(_fd, &value, sizeof(value));
+#endif
+  }
+
+  /**
+   * @return what SeqlockQueueProducer::set_notifier uses to wake the consumer
+   */
+  detail::Waiter waiter() noexcept
+  {
+    detail::Waiter waiter;
+    waiter.armed = &_armed;
+    waiter.wake = &EventNotifier::wake;
+    waiter.context = this;
+    waiter.full_fence = !_process_barrier;
+    return waiter;
+  }
+
+private:
+  void barrier() const noexcept
+  {
+#if defined(__linux__)
+    if (_process_barrier)
+    {
+      ::syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+      return;
+    }
+#endif
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  static void wake(void* context) noexcept
+  {
+    auto* notifier = static_cast<EventNotifier*>(context);
+
+    // Only the first producer to see the flag writes to the eventfd
+    if (notifier->_armed.exchange(0, std::memory_order_acq_rel) != 0)
+    {
+#if defined(__linux__)
+      uint64_t const value{1};
+      [[maybe_unused]] ssize_t const result = ::write(notifier->_fd, &value, sizeof(value));
+#endif
+    }
+  }
+
+private:
+  // Read by the producers on every write, on its own cache line
+  alignas(detail::CACHE_ALIGNED) std::atomic<uint32_t> _armed{0};
+  int _fd{-1};
+  bool _process_barrier{false};
+};
+} // namespace sq
@@ -0,0 +1,285 @@
+#pragma once
+
+#include "seqlock_queue/seqlock_queue.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sq
+{
+/**
+ * How long SeqlockQueueMergeConsumer waits for a queue without messages before it emits messages
+ * of the other queues
+ */
+struct MergeWait
+{
+  // Only emit when every queue has a message, the output is always in order
+  static constexpr MergeWait forever() noexcept
+  {
+    return MergeWait{std::numeric_limits<uint64_t>::max()};
+  }
+
+  // Emit the smallest message available, a message arriving later with a smaller key is emitted
+  // out of order
+  static constexpr MergeWait none() noexcept { return MergeWait{0}; }
+
+  // Wait up to `ns` nanoseconds for a queue that became empty, then emit without it until it
+  // has messages again
+  static constexpr MergeWait for_ns(uint64_t ns) noexcept { return MergeWait{ns}; }
+
+  uint64_t ns;
+};
+
+/**
+ * Reads several queues and returns their messages in the order of a key taken from each message,
+ * e.g. a timestamp or a global sequence. The messages of each queue must already be in that order.
+ * The next message of every queue is kept in a binary heap, so a read costs log(K) comparisons
+ * for K queues.
+ *
+ * @tparam TKey a callable returning the key of a message, keys are compared with operator<
+ */
+template <typename TBoundedSeqlockQueue, typename TKey>
+class SeqlockQueueMergeConsumer
+{
+public:
+  using value_t = typename TBoundedSeqlockQueue::value_t;
+  using consumer_t = SeqlockQueueConsumer<TBoundedSeqlockQueue>;
+  using key_t = std::decay_t<std::invoke_result_t<TKey&, value_t const&>>;
+
+  SeqlockQueueMergeConsumer(SeqlockQueueMergeConsumer const&) = delete;
+  SeqlockQueueMergeConsumer& operator=(SeqlockQueueMergeConsumer const&) = delete;
+  SeqlockQueueMergeConsumer(SeqlockQueueMergeConsumer&&) = delete;
+  SeqlockQueueMergeConsumer& operator=(SeqlockQueueMergeConsumer&&) = delete;
+
+  /**
+   * @param queues the queues to merge, they must outlive the consumer
+   * @param key
+   * @param wait
+   * @param mode
+   * @param start_position
+   */
+  SeqlockQueueMergeConsumer(std::vector<TBoundedSeqlockQueue*> const& queues, TKey key,
+                            MergeWait wait = MergeWait::forever(), ConsumerMode mode = ConsumerMode::Lossy,
+                            StartPosition start_position = StartPosition::oldest())
+    : _key(std::move(key)), _wait(wait)
+  {
+    if (queues.empty())
+    {
+      throw std::runtime_error{"a merge consumer needs at least one queue"};
+    }
+
+    _inputs.reserve(queues.size());
+    _heap.reserve(queues.size());
+    _empty.reserve(queues.size());
+
+    for (TBoundedSeqlockQueue* queue : queues)
+    {
+      _empty.push_back(_inputs.size());
+      _inputs.push_back(Input{std::make_unique<consumer_t>(*queue, mode, start_position), value_t{}, 0});
+    }
+  }
+
+  /**
+   * Non blocking read of the message with the smallest key.
+   * @param result
+   * @return true if successfully read, false when there is no message or the consumer is waiting
+   * for a queue without messages
+   */
+  bool try_read(value_t& result) noexcept
+  {
+    if (!_empty.empty() && !refill())
+    {
+      return false;
+    }
+
+    if (_heap.empty())
+    {
+      return false;
+    }
+
+    size_t const index = _heap.front().input;
+    Input& input = _inputs[index];
+    result = input.head;
+    _last_queue = index;
+
+    // Most of the time the queue has its next message already, it replaces the top of the heap
+    if (input.consumer->try_read(input.head))
+    {
+      _heap.front().key = _key(static_cast<value_t const&>(input.head));
+      sift_down(0);
+    }
+    else
+    {
+      _heap.front() = _heap.back();
+      _heap.pop_back();
+      sift_down(0);
+
+      input.empty_since = 0;
+      _empty.push_back(index);
+    }
+
+    return true;
+  }
+
+  /**
+   * @return the index, in the queues passed to the constructor, of the queue of the last message read
+   */
+  size_t last_queue() const noexcept { return _last_queue; }
+
+  /**
+   * @param index of the queue in the queues passed to the constructor
+   */
+  consumer_t& consumer(size_t index) noexcept { return *_inputs[index].consumer; }
+
+private:
+  struct Input
+  {
+    std::unique_ptr<consumer_t> consumer;
+    value_t head;
+
+    // steady clock time the queue was first found empty, 0 until then
+    uint64_t empty_since;
+  };
+
+  struct HeapEntry
+  {
+    key_t key;
+    size_t input;
+  };
+
+  /**
+   * Reads the next message of the queues without one
+   * @return false when a queue is still empty and the consumer has to wait for it
+   */
+  bool refill() noexcept
+  {
+    for (size_t i = 0; i < _empty.size();)
+    {
+      size_t const index = _empty[i];
+      Input& input = _inputs[index];
+
+      if (input.consumer->try_read(input.head))
+      {
+        _heap.push_back(HeapEntry{_key(static_cast<value_t const&>(input.head)), index});
+        sift_up(_heap.size() - 1);
+
+        _empty[i] = _empty.back();
+        _empty.pop_back();
+      }
+      else
+      {
+        ++i;
+      }
+    }
+
+    if (_empty.empty() || (_wait.ns == 0))
+    {
+      return true;
+    }
+
+    if (_wait.ns == MergeWait::forever().ns)
+    {
+      return false;
+    }
+
+    // Emit once every empty queue has been empty for longer than the wait
+    uint64_t const now = detail::steady_clock_ns();
+    bool waiting{false};
+
+    for (size_t index : _empty)
+    {
+      Input& input = _inputs[index];
+
+      if (input.empty_since == 0)
+      {
+        input.empty_since = now;
+      }
+
+      waiting |= (now - input.empty_since < _wait.ns);
+    }
+
+    return !waiting;
+  }
+
+  bool less(HeapEntry const& lhs, HeapEntry const& rhs) const noexcept
+  {
+    // Messages with equal keys are returned in the order of their queues
+    if (lhs.key < rhs.key)
+    {
+      return true;
+    }
+
+    return !(rhs.key < lhs.key) && (lhs.input < rhs.input);
+  }
+
+  void sift_up(size_t position) noexcept
+  {
+    HeapEntry const entry = _heap[position];
+
+    while (position != 0)
+    {
+      size_t const parent = (position - 1) / 2;
+
+      if (!less(entry, _heap[parent]))
+      {
+        break;
+      }
+
+      _heap[position] = _heap[parent];
+      position = parent;
+    }
+
+    _heap[position] = entry;
+  }
+
+  void sift_down(size_t position) noexcept
+  {
+    size_t const size = _heap.size();
+
+    if (position >= size)
+    {
+      return;
+    }
+
+    HeapEntry const entry = _heap[position];
+
+    while (true)
+    {
+      size_t child = 2 * position + 1;
+
+      if (child >= size)
+      {
+        break;
+      }
+
+      if ((child + 1 < size) && less(_heap[child + 1], _heap[child]))
+      {
+        ++child;
+      }
+
+      if (!less(_heap[child], entry))
+      {
+        break;
+      }
+
+      _heap[position] = _heap[child];
+      position = child;
+    }
+
+    _heap[position] = entry;
+  }
+
+private:
+  TKey _key;
+  MergeWait _wait;
+  std::vector<Input> _inputs;
+  std::vector<HeapEntry> _heap;
+  std::vector<size_t> _empty;
+  size_t _last_queue{0};
+};
+} // namespace sq
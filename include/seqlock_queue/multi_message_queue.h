@@ -0,0 +1,250 @@
+#pragma once
+
+#include "seqlock_queue/seqlock_queue.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace sq
+{
+namespace detail
+{
+template <typename T, typename... TMessages>
+struct message_index;
+
+template <typename T, typename... TMessages>
+struct message_index<T, T, TMessages...> : std::integral_constant<uint32_t, 0>
+{
+};
+
+template <typename T, typename TFirst, typename... TMessages>
+struct message_index<T, TFirst, TMessages...>
+  : std::integral_constant<uint32_t, 1 + message_index<T, TMessages...>::value>
+{
+};
+} // namespace detail
+
+/**
+ * The value of a slot of a MultiMessageSeqlockQueue, one of TMessages and the index of its type.
+ * Unlike a std::variant only the bytes of the message that was written are copied.
+ */
+template <typename... TMessages>
+struct MultiMessage
+{
+  static_assert(sizeof...(TMessages) != 0, "at least one message type is required");
+  static_assert((std::is_trivially_copyable_v<TMessages> && ...), "messages need to be trivially copyable");
+
+  static constexpr size_t max_size{std::max({sizeof(TMessages)...})};
+  static constexpr size_t max_alignment{std::max({alignof(TMessages)...})};
+
+  template <typename T>
+  static constexpr uint32_t index_of{detail::message_index<T, TMessages...>::value};
+
+  uint32_t type;
+  alignas(max_alignment) std::byte storage[max_size];
+};
+
+/**
+ * A queue of several message types, each slot is as large as the largest message
+ */
+template <typename... TMessages>
+using MultiMessageSeqlockQueue = BoundedSeqlockQueue<MultiMessage<TMessages...>>;
+
+/**
+ * Writes messages of any of the types of a MultiMessageSeqlockQueue, only the bytes of the message
+ * are written to the slot
+ */
+template <typename TBoundedSeqlockQueue>
+class MultiMessageSeqlockQueueProducer
+{
+public:
+  using value_t = typename TBoundedSeqlockQueue::value_t;
+
+  MultiMessageSeqlockQueueProducer(MultiMessageSeqlockQueueProducer const&) = delete;
+  MultiMessageSeqlockQueueProducer& operator=(MultiMessageSeqlockQueueProducer const&) = delete;
+  MultiMessageSeqlockQueueProducer(MultiMessageSeqlockQueueProducer&&) = delete;
+  MultiMessageSeqlockQueueProducer& operator=(MultiMessageSeqlockQueueProducer&&) = delete;
+
+  /**
+   * @param bounded_seqlock_queue
+   * @param wait_strategy how writes wait for lossless consumers to make room
+   */
+  explicit MultiMessageSeqlockQueueProducer(TBoundedSeqlockQueue const& bounded_seqlock_queue,
+                                            WaitStrategy wait_strategy = WaitStrategy::Spin)
+    : _producer(bounded_seqlock_queue, wait_strategy)
+  {
+  }
+
+  /**
+   * @param message one of the message types of the queue
+   */
+  template <typename TMessage>
+  void write(TMessage const& message) noexcept
+  {
+    _producer.write(
+      [&message](value_t& slot_value)
+      {
+        slot_value.type = value_t::template index_of<TMessage>;
+        std::memcpy(slot_value.storage, &message, sizeof(TMessage));
+      });
+  }
+
+  /**
+   * Constructs the message in place in the slot
+   * @param args the arguments of the constructor of TMessage
+   */
+  template <typename TMessage, typename... TArgs>
+  void emplace(TArgs&&... args) noexcept
+  {
+    _producer.write(
+      [&args...](value_t& slot_value)
+      {
+        slot_value.type = value_t::template index_of<TMessage>;
+        new (slot_value.storage) TMessage{std::forward<TArgs>(args)...};
+      });
+  }
+
+  /**
+   * @return the underlying producer
+   */
+  SeqlockQueueProducer<TBoundedSeqlockQueue>& producer() noexcept { return _producer; }
+
+private:
+  SeqlockQueueProducer<TBoundedSeqlockQueue> _producer;
+};
+
+/**
+ * Reads a MultiMessageSeqlockQueue. The type index of the message selects an entry of a jump table
+ * built at compile time, which copies only sizeof(TMessage) bytes out of the slot and passes the
+ * message to the visitor.
+ */
+template <typename TBoundedSeqlockQueue>
+class MultiMessageSeqlockQueueConsumer
+{
+public:
+  using value_t = typename TBoundedSeqlockQueue::value_t;
+  using slot_t = typename TBoundedSeqlockQueue::slot_t;
+  using consumer_t = SeqlockQueueConsumer<TBoundedSeqlockQueue>;
+
+  MultiMessageSeqlockQueueConsumer(MultiMessageSeqlockQueueConsumer const&) = delete;
+  MultiMessageSeqlockQueueConsumer& operator=(MultiMessageSeqlockQueueConsumer const&) = delete;
+  MultiMessageSeqlockQueueConsumer(MultiMessageSeqlockQueueConsumer&&) = delete;
+  MultiMessageSeqlockQueueConsumer& operator=(MultiMessageSeqlockQueueConsumer&&) = delete;
+
+  /**
+   * @param bounded_seqlock_queue
+   * @param mode
+   * @param start_position
+   */
+  explicit MultiMessageSeqlockQueueConsumer(TBoundedSeqlockQueue& bounded_seqlock_queue,
+                                            ConsumerMode mode = ConsumerMode::Lossy,
+                                            StartPosition start_position = StartPosition::oldest())
+    : _consumer(bounded_seqlock_queue, mode, start_position)
+  {
+  }
+
+  /**
+   * Non blocking read of the next message.
+   * @param visitor invoked as visitor(TMessage const&) with the message when one was read
+   * @return true if successfully read, false otherwise
+   */
+  template <typename TVisitor>
+  bool try_read(TVisitor&& visitor) noexcept
+  {
+    return read(visitor, std::make_index_sequence<message_count()>{});
+  }
+
+  /**
+   * @return the underlying consumer, e.g. for seek or sequence
+   */
+  consumer_t& consumer() noexcept { return _consumer; }
+
+private:
+  template <typename... TMessages>
+  static constexpr size_t count_messages(MultiMessage<TMessages...> const*) noexcept
+  {
+    return sizeof...(TMessages);
+  }
+
+  static constexpr size_t message_count() noexcept { return count_messages(static_cast<value_t const*>(nullptr)); }
+
+  template <size_t Index, typename... TMessages>
+  static auto nth_message(MultiMessage<TMessages...> const*)
+    -> std::tuple_element_t<Index, std::tuple<TMessages...>>;
+
+  template <size_t Index>
+  using message_t = decltype(nth_message<Index>(static_cast<value_t const*>(nullptr)));
+
+  template <typename TVisitor, size_t... Indices>
+  bool read(TVisitor& visitor, std::index_sequence<Indices...>) noexcept
+  {
+    using read_function_t = ReadResult (*)(consumer_t&, slot_t const&, uint64_t, TVisitor&);
+    static constexpr read_function_t jump_table[]{&read_message<message_t<Indices>, TVisitor>...};
+
+    slot_t const& slot = _consumer._slots[_consumer._read_index & _consumer._mask];
+
+    uint64_t const version = slot.version.load(std::memory_order_acquire);
+
+    if (version & detail::VERSION_WRITING) [[unlikely]]
+    {
+      _consumer.read_torn();
+      return false;
+    }
+
+    if ((detail::next_sequence(version) != _consumer._read_index + 1) && _consumer.skip_trimmed()) [[unlikely]]
+    {
+      return read(visitor, std::index_sequence<Indices...>{});
+    }
+
+    if (version < detail::published_version(_consumer._read_index))
+    {
+      return false;
+    }
+
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+
+    // The type is checked before it is used, the version check can only reject it afterwards
+    uint32_t const type = slot.value.type;
+
+    if (type >= message_count()) [[unlikely]]
+    {
+      _consumer.read_torn();
+      return false;
+    }
+
+    return jump_table[type](_consumer, slot, version, visitor) == ReadResult::Success;
+  }
+
+  template <typename TMessage, typename TVisitor>
+  static ReadResult read_message(consumer_t& consumer, slot_t const& slot, uint64_t version,
+                                 TVisitor& visitor) noexcept
+  {
+    alignas(TMessage) std::byte buffer[sizeof(TMessage)];
+    std::memcpy(buffer, slot.value.storage, sizeof(TMessage));
+
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+
+    if (slot.version.load(std::memory_order_acquire) != version) [[unlikely]]
+    {
+      consumer.read_torn();
+      return ReadResult::Busy;
+    }
+
+    // Continue after the message, skipping the ones that were overwritten when the version is newer
+    consumer._read_index = detail::next_sequence(version);
+    consumer.read_succeeded(1);
+
+    visitor(*std::launder(reinterpret_cast<TMessage const*>(buffer)));
+    return ReadResult::Success;
+  }
+
+private:
+  consumer_t _consumer;
+};
+} // namespace sq
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "seqlock_queue/seqlock_queue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace sq
+{
+/**
+ * A stage of a pipeline over a single queue, in the style of the Disruptor. Every stage registers
+ * one of the gating cursors of the queue, so the producer never overwrites a message a stage has
+ * not processed, and processes the messages in place in the slots without copying them. A stage
+ * only processes a message once all its upstream stages have processed it.
+ *
+ * Stages pass results downstream through a StageSideArray indexed by sequence instead of writing
+ * to the slots, which lossy consumers of the same queue may be reading.
+ */
+template <typename TBoundedSeqlockQueue>
+class SeqlockQueueStage
+{
+public:
+  using value_t = typename TBoundedSeqlockQueue::value_t;
+  using slot_t = typename TBoundedSeqlockQueue::slot_t;
+
+  SeqlockQueueStage(SeqlockQueueStage const&) = delete;
+  SeqlockQueueStage& operator=(SeqlockQueueStage const&) = delete;
+  SeqlockQueueStage(SeqlockQueueStage&&) = delete;
+  SeqlockQueueStage& operator=(SeqlockQueueStage&&) = delete;
+
+  /**
+   * A first stage, that processes the messages once the producer has published them. Starts at
+   * the producer's current position.
+   * @param bounded_seqlock_queue a queue with a free gating cursor for each stage
+   */
+  explicit SeqlockQueueStage(TBoundedSeqlockQueue& bounded_seqlock_queue)
+    : SeqlockQueueStage(bounded_seqlock_queue, {})
+  {
+  }
+
+  /**
+   * A stage that processes the messages once all the upstream stages have processed them. Starts
+   * at the position of the slowest upstream stage.
+   * @param bounded_seqlock_queue a queue with a free gating cursor for each stage
+   * @param upstream stages of the same queue, they must outlive this stage
+   */
+  SeqlockQueueStage(TBoundedSeqlockQueue& bounded_seqlock_queue,
+                    std::initializer_list<SeqlockQueueStage const*> upstream)
+    : _slots(bounded_seqlock_queue._slots),
+      _mask(bounded_seqlock_queue._mask)
+  {
+    for (SeqlockQueueStage const* stage : upstream)
+    {
+      _upstream.push_back(stage->_cursor);
+    }
+
+    _sequence = _upstream.empty()
+      ? detail::find_write_index(_slots, bounded_seqlock_queue._capacity, bounded_seqlock_queue._trim_write_index)
+      : upstream_sequence();
+
+    _cursor = detail::register_gating_cursor(bounded_seqlock_queue._gating_cursors,
+                                             bounded_seqlock_queue._gating_cursor_count,
+                                             bounded_seqlock_queue._gating_limit, bounded_seqlock_queue._capacity,
+                                             _sequence);
+
+    if (!_cursor)
+    {
+      throw std::runtime_error{"no gating cursor available for a pipeline stage"};
+    }
+  }
+
+  ~SeqlockQueueStage() { _cursor->sequence.store(detail::GatingCursor::unused, std::memory_order_release); }
+
+  /**
+   * Processes the available messages in place, then publishes the new position of the stage to
+   * the downstream stages and the producer.
+   * @param callback called with (value_t const& value, uint64_t sequence) for each message
+   * @param max_count
+   * @return the number of messages processed
+   */
+  template <typename TCallback>
+  size_t process(TCallback callback, size_t max_count = 64)
+  {
+    size_t const count = available(max_count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      callback(static_cast<value_t const&>(_slots[(_sequence + i) & _mask].value), _sequence + i);
+    }
+
+    if (count != 0)
+    {
+      _sequence += count;
+      _cursor->sequence.store(_sequence, std::memory_order_release);
+    }
+
+    return count;
+  }
+
+  /**
+   * @return the sequence of the next message the stage processes
+   */
+  uint64_t sequence() const noexcept { return _sequence; }
+
+private:
+  size_t available(size_t max_count) const noexcept
+  {
+    if (_upstream.empty())
+    {
+      // The producer can not overwrite these slots before this stage moves its cursor, so the run
+      // stays valid while it is processed
+      return detail::published_run(_slots, _mask, _sequence, max_count);
+    }
+
+    uint64_t const upstream = upstream_sequence();
+    return upstream - _sequence < max_count ? static_cast<size_t>(upstream - _sequence) : max_count;
+  }
+
+  uint64_t upstream_sequence() const noexcept
+  {
+    uint64_t min_sequence = std::numeric_limits<uint64_t>::max();
+
+    for (detail::GatingCursor const* cursor : _upstream)
+    {
+      uint64_t const sequence = cursor->sequence.load(std::memory_order_acquire);
+      min_sequence = sequence < min_sequence ? sequence : min_sequence;
+    }
+
+    return min_sequence;
+  }
+
+private:
+  slot_t const* _slots{nullptr};
+  size_t _mask{0};
+  uint64_t _sequence{0};
+  detail::GatingCursor* _cursor{nullptr};
+  std::vector<detail::GatingCursor const*> _upstream;
+};
+
+/**
+ * Per message results a stage passes to the downstream stages, one entry per slot of the queue.
+ * The entry of a message is written by one stage before it publishes its position, and read by
+ * the stages after it, the producer can not reuse it before every stage has processed the message.
+ */
+template <typename T>
+class StageSideArray
+{
+public:
+  /**
+   * @param capacity the capacity of the queue
+   */
+  explicit StageSideArray(size_t capacity)
+    : _values(detail::next_power_of_2(capacity)), _mask(_values.size() - 1)
+  {
+  }
+
+  /***/
+  T& operator[](uint64_t sequence) noexcept { return _values[sequence & _mask]; }
+
+  /***/
+  T const& operator[](uint64_t sequence) const noexcept { return _values[sequence & _mask]; }
+
+private:
+  std::vector<T> _values;
+  size_t _mask{0};
+};
+} // namespace sq
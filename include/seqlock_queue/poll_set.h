@@ -0,0 +1,216 @@
+#pragma once
+
+#include "seqlock_queue/seqlock_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace sq
+{
+/**
+ * How SeqlockQueuePollSet shares a poll between its queues
+ */
+enum class PollPolicy : uint8_t
+{
+  /** Every queue with messages gets one batch per poll, starting with a different queue each poll */
+  RoundRobin,
+  /** Only the queue with the highest priority that has messages gets a batch */
+  Priority,
+  /** Every queue with messages gets up to weight batches per poll */
+  Weighted
+};
+
+/**
+ * Reads several queues of the same type from one thread. The poll set owns one consumer per
+ * queue and drains them in batches according to its PollPolicy. Queues without messages are
+ * skipped after a single load of the version of their next slot, so idle queues cost little.
+ */
+template <typename TBoundedSeqlockQueue>
+class SeqlockQueuePollSet
+{
+public:
+  using value_t = typename TBoundedSeqlockQueue::value_t;
+  using consumer_t = SeqlockQueueConsumer<TBoundedSeqlockQueue>;
+
+  SeqlockQueuePollSet(SeqlockQueuePollSet const&) = delete;
+  SeqlockQueuePollSet& operator=(SeqlockQueuePollSet const&) = delete;
+  SeqlockQueuePollSet(SeqlockQueuePollSet&&) = delete;
+  SeqlockQueuePollSet& operator=(SeqlockQueuePollSet&&) = delete;
+
+  /**
+   * @param policy
+   * @param batch_size the maximum number of messages read from a queue at once
+   */
+  explicit SeqlockQueuePollSet(PollPolicy policy = PollPolicy::RoundRobin, size_t batch_size = 16)
+    : _batch(batch_size), _policy(policy)
+  {
+    if (batch_size == 0)
+    {
+      throw std::runtime_error{"batch_size must be greater than 0"};
+    }
+  }
+
+  /**
+   * Adds a consumer of the queue to the poll set.
+   * @param bounded_seqlock_queue
+   * @param rank the priority of the queue with PollPolicy::Priority, higher is served first, or
+   * its weight with PollPolicy::Weighted. Ignored with PollPolicy::RoundRobin
+   * @param mode
+   * @param start_position
+   * @return the index of the queue, passed to the poll callback
+   */
+  size_t add(TBoundedSeqlockQueue& bounded_seqlock_queue, uint32_t rank = 1, ConsumerMode mode = ConsumerMode::Lossy,
+             StartPosition start_position = StartPosition::oldest())
+  {
+    if ((_policy == PollPolicy::Weighted) && (rank == 0))
+    {
+      throw std::runtime_error{"the weight of a queue must be greater than 0"};
+    }
+
+    size_t const index = _consumers.size();
+    _consumers.push_back(std::make_unique<consumer_t>(bounded_seqlock_queue, mode, start_position));
+
+    Entry entry{nullptr, 0, _consumers.back().get(), index, rank};
+    entry.update();
+
+    if (_policy == PollPolicy::Priority)
+    {
+      // Kept sorted by priority, queues with the same priority in the order they were added
+      auto const position = std::upper_bound(_entries.begin(), _entries.end(), entry,
+                                             [](Entry const& lhs, Entry const& rhs) { return lhs.rank > rhs.rank; });
+      _entries.insert(position, entry);
+    }
+    else
+    {
+      _entries.push_back(entry);
+    }
+
+    return index;
+  }
+
+  /**
+   * Non blocking read of the available messages according to the policy.
+   * @param callback invoked as callback(size_t index, value_t const& value) for every message read
+   * @return the number of messages read
+   */
+  template <typename TCallback>
+  size_t poll(TCallback&& callback)
+  {
+    size_t const entries = _entries.size();
+
+    if (entries == 0)
+    {
+      return 0;
+    }
+
+    if (_policy == PollPolicy::Priority)
+    {
+      for (Entry& entry : _entries)
+      {
+        if (!entry.empty())
+        {
+          return drain(entry, 1, callback);
+        }
+      }
+
+      return 0;
+    }
+
+    // Start one queue further each poll, so the first queue does not always go first
+    size_t const first = _next;
+    _next = (_next + 1 == entries) ? 0 : _next + 1;
+
+    size_t count{0};
+    for (size_t i = 0, index = first; i < entries; ++i, index = (index + 1 == entries) ? 0 : index + 1)
+    {
+      Entry& entry = _entries[index];
+
+      if (!entry.empty())
+      {
+        count += drain(entry, (_policy == PollPolicy::Weighted) ? entry.rank : 1, callback);
+      }
+    }
+
+    return count;
+  }
+
+  /**
+   * The poll set caches the position of each consumer. After a consumer is moved back with seek,
+   * its older messages are only polled once the producer writes to its queue again.
+   * @param index as returned by add
+   */
+  consumer_t& consumer(size_t index) noexcept { return *_consumers[index]; }
+
+  /**
+   * @return the number of queues
+   */
+  size_t size() const noexcept { return _consumers.size(); }
+
+private:
+  /**
+   * Caches the version of the next slot of the consumer and the version it has once the next
+   * message is published, so checking an idle queue loads a single value. A reset slot is handed
+   * to the consumer, which knows whether a trim left retained messages ahead of it.
+   */
+  struct Entry
+  {
+    bool empty() const noexcept
+    {
+      uint64_t const current = version->load(std::memory_order_relaxed);
+      return (current < published) && ((current != 0) || consumer->empty());
+    }
+
+    void update() noexcept
+    {
+      version = &consumer->_slots[consumer->_read_index & consumer->_mask].version;
+      published = detail::published_version(consumer->_read_index);
+    }
+
+    std::atomic<uint64_t> const* version;
+    uint64_t published;
+    consumer_t* consumer;
+    size_t index;
+    uint32_t rank;
+  };
+
+  /**
+   * Reads up to batches full batches from the queue of the entry
+   */
+  template <typename TCallback>
+  size_t drain(Entry& entry, uint32_t batches, TCallback& callback)
+  {
+    size_t count{0};
+
+    for (uint32_t batch = 0; batch < batches; ++batch)
+    {
+      size_t const read = entry.consumer->try_read_batch(_batch.data(), _batch.size());
+
+      for (size_t i = 0; i < read; ++i)
+      {
+        callback(entry.index, static_cast<value_t const&>(_batch[i]));
+      }
+
+      count += read;
+
+      if (read != _batch.size())
+      {
+        break;
+      }
+    }
+
+    entry.update();
+    return count;
+  }
+
+private:
+  std::vector<std::unique_ptr<consumer_t>> _consumers;
+  std::vector<Entry> _entries;
+  std::vector<value_t> _batch;
+  size_t _next{0};
+  PollPolicy _policy;
+};
+} // namespace sq
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "seqlock_queue/seqlock_queue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace sq
+{
+/**
+ * A bitmap with one bit per queue, for a consumer of thousands of mostly idle queues. The producer
+ * of each queue sets the bit of its queue after writing (SeqlockQueueProducer::set_ready_set) and
+ * the consumer polls the set to find the queues with new messages, so a poll costs in proportion
+ * to the active queues rather than to all of them.
+ *
+ * The bits are grouped by cache line, 512 queues per line, and a summary word holds one bit per
+ * line, so lines without set bits are not read either. Any number of producers can mark the set,
+ * only one thread may poll it.
+ */
+class ReadySet
+{
+public:
+  static constexpr size_t words_per_group{detail::CACHE_ALIGNED / sizeof(uint64_t)};
+  static constexpr size_t rings_per_group{words_per_group * 64u};
+
+  ReadySet(ReadySet const&) = delete;
+  ReadySet& operator=(ReadySet const&) = delete;
+  ReadySet(ReadySet&&) = delete;
+  ReadySet& operator=(ReadySet&&) = delete;
+
+  /**
+   * @param ring_count the number of queues
+   */
+  explicit ReadySet(size_t ring_count)
+    : _ring_count(ring_count),
+      _group_count((ring_count + rings_per_group - 1) / rings_per_group),
+      _summary_count((_group_count + 63u) / 64u)
+  {
+    if (ring_count == 0)
+    {
+      throw std::runtime_error{"ring_count must be greater than 0"};
+    }
+
+    _words = static_cast<std::atomic<uint64_t>*>(detail::alloc_aligned(
+      sizeof(std::atomic<uint64_t>) * _group_count * words_per_group, detail::CACHE_ALIGNED, false));
+
+    for (size_t i = 0; i < _group_count * words_per_group; ++i)
+    {
+      new (_words + i) std::atomic<uint64_t>{0};
+    }
+
+    _summary = static_cast<std::atomic<uint64_t>*>(
+      detail::alloc_aligned(sizeof(std::atomic<uint64_t>) * _summary_count, detail::CACHE_ALIGNED, false));
+
+    for (size_t i = 0; i < _summary_count; ++i)
+    {
+      new (_summary + i) std::atomic<uint64_t>{0};
+    }
+  }
+
+  ~ReadySet()
+  {
+    detail::free_aligned(_words);
+    detail::free_aligned(_summary);
+  }
+
+  /**
+   * @param ring
+   * @return the bit of the ring, as used by SeqlockQueueProducer::set_ready_set
+   */
+  detail::ReadyBit ready_bit(size_t ring) const
+  {
+    if (ring >= _ring_count)
+    {
+      throw std::runtime_error{"invalid ring index " + std::to_string(ring)};
+    }
+
+    size_t const group = ring / rings_per_group;
+
+    detail::ReadyBit ready_bit;
+    ready_bit.word = _words + (ring / 64u);
+    ready_bit.word_bit = uint64_t{1} << (ring % 64u);
+    ready_bit.summary = _summary + (group / 64u);
+    ready_bit.summary_bit = uint64_t{1} << (group % 64u);
+    return ready_bit;
+  }
+
+  /**
+   * Sets the bit of the ring, for producers that do not use set_ready_set
+   */
+  void mark(size_t ring) const { ready_bit(ring).mark(); }
+
+  /**
+   * Clears the bits that are set and invokes the callback for each of their rings, in the order of
+   * the ring indices. The callback should read all the messages of the ring, the ring is only
+   * reported again after its producer writes again.
+   * @param callback invoked as callback(size_t ring)
+   * @return the number of rings reported
+   */
+  template <typename TCallback>
+  size_t poll(TCallback&& callback)
+  {
+    size_t count{0};
+
+    for (size_t summary_index = 0; summary_index < _summary_count; ++summary_index)
+    {
+      if (_summary[summary_index].load(std::memory_order_relaxed) == 0)
+      {
+        continue;
+      }
+
+      // The summary bits are cleared before the words, a producer setting a word later also sets
+      // its summary bit again
+      uint64_t groups = _summary[summary_index].exchange(0, std::memory_order_seq_cst);
+
+      while (groups != 0)
+      {
+        size_t const group = summary_index * 64u + detail::count_trailing_zeros(groups);
+        groups &= groups - 1;
+
+        std::atomic<uint64_t>* const group_words = _words + group * words_per_group;
+        uint64_t bits[words_per_group];
+
+        for (size_t i = 0; i < words_per_group; ++i)
+        {
+          bits[i] = group_words[i].load(std::memory_order_seq_cst)
+            ? group_words[i].exchange(0, std::memory_order_seq_cst)
+            : 0;
+        }
+
+        // Pairs with the fence in ReadyBit::mark, the messages written before a producer found its
+        // bit still set are visible to the callback
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        for (size_t i = 0; i < words_per_group; ++i)
+        {
+          while (bits[i] != 0)
+          {
+            size_t const bit = detail::count_trailing_zeros(bits[i]);
+            callback((group * words_per_group + i) * 64u + bit);
+            bits[i] &= bits[i] - 1;
+            ++count;
+          }
+        }
+      }
+    }
+
+    return count;
+  }
+
+  /**
+   * @return the number of queues
+   */
+  size_t ring_count() const noexcept { return _ring_count; }
+
+private:
+  std::atomic<uint64_t>* _words{nullptr};
+  std::atomic<uint64_t>* _summary{nullptr};
+  size_t _ring_count{0};
+  size_t _group_count{0};
+  size_t _summary_count{0};
+};
+} // namespace sq
@@ -1,13 +1,16 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <limits>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <type_traits>
 
 #if defined(_WIN32)
@@ -20,9 +23,29 @@
   #include <sys/mman.h>
 #endif
 
+#if !defined(_WIN32)
+  #include <unistd.h>
+#endif
+
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+  #define SEQLOCK_QUEUE_X86_64
+  #include <immintrin.h>
+
+  // Runtime cpu feature dispatch to functions compiled for a specific target
+  #if defined(__GNUC__) || defined(__clang__)
+    #define SEQLOCK_QUEUE_CPU_DISPATCH
+  #endif
+#endif
+
 namespace sq::detail
 {
 constexpr uint32_t CACHE_ALIGNED{64u};
+constexpr size_t HUGE_PAGE_SIZE{2u * 1024u * 1024u};
+
 /***/
 constexpr bool is_pow_of_two(uint64_t number) noexcept
 {
@@ -30,7 +53,7 @@ constexpr bool is_pow_of_two(uint64_t number) noexcept
 }
 
 /***/
-uint64_t next_power_of_2(uint64_t n)
+inline uint64_t next_power_of_2(uint64_t n)
 {
   constexpr uint64_t max_power_of_2 = (std::numeric_limits<uint64_t>::max() >> 1u) + 1u;
 
@@ -42,7 +65,7 @@ uint64_t next_power_of_2(uint64_t n)
   return is_pow_of_two(static_cast<uint64_t>(n)) ? n : static_cast<uint64_t>(std::pow(2u, log2(n) + 1u));
 }
 
-void* align_pointer(void* pointer, size_t alignment) noexcept
+inline void* align_pointer(void* pointer, size_t alignment) noexcept
 {
   if (alignment == 0)
   {
@@ -54,7 +77,7 @@ void* align_pointer(void* pointer, size_t alignment) noexcept
 }
 
 /***/
-void* alloc_aligned(size_t size, size_t alignment, bool huge_pages /* = false */)
+inline void* alloc_aligned(size_t size, size_t alignment, bool huge_pages /* = false */)
 {
 #if defined(_WIN32)
   void* p = _aligned_malloc(size, alignment);
@@ -103,7 +126,7 @@ void* alloc_aligned(size_t size, size_t alignment, bool huge_pages /* = false */
 }
 
 /***/
-void free_aligned(void* ptr) noexcept
+inline void free_aligned(void* ptr) noexcept
 {
 #if defined(_WIN32)
   _aligned_free(ptr);
@@ -121,199 +144,2103 @@ void free_aligned(void* ptr) noexcept
   ::munmap(mem, total_size);
 #endif
 }
-} // namespace sq::detail
 
-namespace sq
+/***/
+inline size_t page_size(bool huge_pages) noexcept
 {
-template <typename T, size_t Alignment>
-struct alignas(Alignment) Slot
+#if defined(_WIN32)
+  (void)huge_pages;
+  return 4096u;
+#else
+  return huge_pages ? HUGE_PAGE_SIZE : static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+}
+
+/**
+ * Returns the whole pages inside [begin, end) to the OS. Pages that are only partially covered by
+ * the range are kept. The released pages read back as zeroes when they are touched again.
+ * @return the number of bytes released
+ */
+inline size_t release_pages(void* begin, void* end, size_t page_size) noexcept
 {
-  static_assert(std::is_trivially_copyable<T>::value, "T needs to be trivially copyable");
+#if defined(_WIN32)
+  (void)begin;
+  (void)end;
+  (void)page_size;
+  return 0;
+#else
+  auto const first = reinterpret_cast<uintptr_t>(align_pointer(begin, page_size));
+  auto const last = reinterpret_cast<uintptr_t>(end) & ~(page_size - 1u);
 
-  T value;
-  std::atomic<uint8_t> version{std::numeric_limits<uint8_t>::max() - 1u};
-};
+  if (first >= last)
+  {
+    return 0;
+  }
 
-/***/
-template <typename T, size_t SlotAlignment = detail::CACHE_ALIGNED, size_t CacheAligned = detail::CACHE_ALIGNED>
-class BoundedSeqlockQueue
+  #if defined(__linux__)
+  int const advice = MADV_DONTNEED;
+  #else
+  int const advice = MADV_FREE;
+  #endif
+
+  if (::madvise(reinterpret_cast<void*>(first), last - first, advice) != 0)
+  {
+    return 0;
+  }
+
+  return last - first;
+#endif
+}
+
+/**
+ * Processors that support AVX guarantee that aligned 16 byte loads and stores are atomic
+ */
+inline bool has_atomic_16b_access() noexcept
 {
-public:
-  using value_t = T;
-  using slot_t = Slot<value_t, SlotAlignment>;
+#if defined(SEQLOCK_QUEUE_CPU_DISPATCH)
+  return __builtin_cpu_supports("avx");
+#else
+  return false;
+#endif
+}
 
-  BoundedSeqlockQueue(BoundedSeqlockQueue const&) = delete;
-  BoundedSeqlockQueue& operator=(BoundedSeqlockQueue const&) = delete;
-  BoundedSeqlockQueue(BoundedSeqlockQueue&&) = delete;
-  BoundedSeqlockQueue& operator=(BoundedSeqlockQueue&&) = delete;
+/**
+ * The widest vector extension available to the copy kernels
+ */
+enum class SimdLevel : uint8_t
+{
+  Scalar,
+  Avx2,
+  Avx512
+};
 
-  BoundedSeqlockQueue(size_t capacity, bool huge_pages = false)
-    : _capacity(detail::next_power_of_2(capacity)), _mask(_capacity - 1)
+/***/
+inline SimdLevel simd_level() noexcept
+{
+#if defined(SEQLOCK_QUEUE_CPU_DISPATCH)
+  static SimdLevel const level = []()
   {
-    // Construct in place the objects
-    _slots = static_cast<slot_t*>(detail::alloc_aligned(sizeof(slot_t) * _capacity, CacheAligned, huge_pages));
+    if (__builtin_cpu_supports("avx512f"))
+    {
+      return SimdLevel::Avx512;
+    }
 
-    for (uint64_t i = 0; i < capacity; ++i)
+    if (__builtin_cpu_supports("avx2"))
     {
-      new (_slots + i) slot_t{};
+      return SimdLevel::Avx2;
     }
-  };
 
-  ~BoundedSeqlockQueue() { detail::free_aligned(_slots); }
+    return SimdLevel::Scalar;
+  }();
 
-  template <typename>
-  friend class SeqlockQueueProducer;
+  return level;
+#else
+  return SimdLevel::Scalar;
+#endif
+}
 
-  template <typename>
-  friend class SeqlockQueueConsumer;
+/**
+ * True when the value and the version of the slot share one 16 byte aligned word, which is the
+ * case for a SlotAlignment of 16 and a value of up to 8 bytes
+ */
+template <typename TSlot>
+constexpr bool is_packed_slot_v =
+#if defined(SEQLOCK_QUEUE_X86_64)
+  (sizeof(TSlot) == 16u) && (alignof(TSlot) == 16u);
+#else
+  false;
+#endif
 
-private:
-  slot_t* _slots{nullptr};
-  size_t _capacity{0};
-  size_t _mask{0};
-};
+#if defined(SEQLOCK_QUEUE_X86_64)
+/***/
+template <typename T>
+void store_packed(void* slot, T const& value, uint64_t version) noexcept
+{
+  uint64_t bits{0};
+  std::memcpy(&bits, &value, sizeof(T));
+  _mm_store_si128(static_cast<__m128i*>(slot),
+                  _mm_set_epi64x(static_cast<int64_t>(version), static_cast<int64_t>(bits)));
+}
+
+/**
+ * @return the version of the slot, loaded together with the value
+ */
+template <typename T>
+uint64_t load_packed(void const* slot, T& value) noexcept
+{
+  __m128i const word = _mm_load_si128(static_cast<__m128i const*>(slot));
+
+  auto const bits = static_cast<uint64_t>(_mm_cvtsi128_si64(word));
+  std::memcpy(&value, &bits, sizeof(T));
+
+  return static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(word, word)));
+}
+#endif
+
+#if defined(SEQLOCK_QUEUE_X86_64)
+/**
+ * Copies with non temporal stores that bypass the cache. The destination must be 16 byte aligned.
+ * The stores are weakly ordered and need an sfence before they are published
+ */
+template <size_t Size>
+void stream_copy(void* dst, void const* src) noexcept
+{
+  auto* d = static_cast<std::byte*>(dst);
+  auto const* s = static_cast<std::byte const*>(src);
+
+  for (size_t i = 0; i < Size / 16u; ++i)
+  {
+    _mm_stream_si128(reinterpret_cast<__m128i*>(d + i * 16u),
+                     _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i * 16u)));
+  }
+
+  constexpr size_t offset = (Size / 16u) * 16u;
+
+  if constexpr ((Size % 16u) >= 8u)
+  {
+    long long bits;
+    std::memcpy(&bits, s + offset, sizeof(bits));
+    _mm_stream_si64(reinterpret_cast<long long*>(d + offset), bits);
+  }
 
+  if constexpr ((Size % 8u) != 0)
+  {
+    std::memcpy(d + (Size / 8u) * 8u, s + (Size / 8u) * 8u, Size % 8u);
+  }
+}
+#endif
+
+/**
+ * Values of at least this size are copied in and out of the slots with the vectorized kernels,
+ * smaller values are left to the compiler
+ */
+constexpr size_t VECTOR_COPY_MIN_SIZE{256u};
+
+/**
+ * Values of at least these sizes are left to the compiler's memcpy again, which uses rep movsb on
+ * processors with fast string moves and beats the kernels from there, see copy_kernel_benchmark
+ */
+constexpr size_t AVX2_COPY_MAX_SIZE{1024u};
+constexpr size_t AVX512_COPY_MAX_SIZE{2048u};
+
+#if defined(SEQLOCK_QUEUE_CPU_DISPATCH)
 /***/
-template <typename TBoundedSeqlockQueue>
-class SeqlockQueueProducer
+template <size_t Size>
+__attribute__((target("avx2"))) void copy_avx2(void* dst, void const* src) noexcept
 {
-public:
-  using value_t = typename TBoundedSeqlockQueue::value_t;
-  using slot_t = typename TBoundedSeqlockQueue::slot_t;
+  auto* d = static_cast<std::byte*>(dst);
+  auto const* s = static_cast<std::byte const*>(src);
 
-  SeqlockQueueProducer(SeqlockQueueProducer const&) = delete;
-  SeqlockQueueProducer& operator=(SeqlockQueueProducer const&) = delete;
-  SeqlockQueueProducer(SeqlockQueueProducer&&) = delete;
-  SeqlockQueueProducer& operator=(SeqlockQueueProducer&&) = delete;
+  for (size_t i = 0; i < Size / 32u; ++i)
+  {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i * 32u),
+                        _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s + i * 32u)));
+  }
 
-  explicit SeqlockQueueProducer(TBoundedSeqlockQueue const& bounded_seqlock_queue)
-    : _slots(bounded_seqlock_queue._slots),
-      _capacity(bounded_seqlock_queue._capacity),
-      _mask(bounded_seqlock_queue._mask)
+  if constexpr ((Size % 32u) != 0)
   {
+    std::memcpy(d + (Size / 32u) * 32u, s + (Size / 32u) * 32u, Size % 32u);
   }
+}
 
-  template <typename T>
-  void write(T callback) noexcept
+/***/
+template <size_t Size>
+__attribute__((target("avx512f"))) void copy_avx512(void* dst, void const* src) noexcept
+{
+  auto* d = static_cast<std::byte*>(dst);
+  auto const* s = static_cast<std::byte const*>(src);
+
+  for (size_t i = 0; i < Size / 64u; ++i)
   {
-    slot_t& slot = _slots[_write_index++ & _mask];
+    _mm512_storeu_si512(d + i * 64u, _mm512_loadu_si512(s + i * 64u));
+  }
 
-    uint8_t const current_version = slot.version.load(std::memory_order_relaxed);
-    slot.version.store(current_version + 1, std::memory_order_release);
-    std::atomic_signal_fence(std::memory_order_acq_rel);
+  constexpr size_t offset = (Size / 64u) * 64u;
 
-    callback(slot.value);
+  if constexpr ((Size % 64u) >= 32u)
+  {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + offset),
+                        _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s + offset)));
+  }
 
-    std::atomic_signal_fence(std::memory_order_acq_rel);
-    slot.version.store(current_version + 2, std::memory_order_release);
+  if constexpr ((Size % 32u) != 0)
+  {
+    std::memcpy(d + (Size / 32u) * 32u, s + (Size / 32u) * 32u, Size % 32u);
   }
+}
+#endif
 
-  void write(value_t const& value) noexcept
+/**
+ * Copies a value in or out of a slot with the kernel for the given simd level, when that kernel is
+ * faster than memcpy for the size of the value
+ */
+template <typename T>
+void copy_value(T& dst, T const& src, [[maybe_unused]] SimdLevel level) noexcept
+{
+#if defined(SEQLOCK_QUEUE_CPU_DISPATCH)
+  if constexpr ((sizeof(T) >= VECTOR_COPY_MIN_SIZE) && (sizeof(T) < AVX512_COPY_MAX_SIZE))
   {
-    slot_t& slot = _slots[_write_index++ & _mask];
+    if (level == SimdLevel::Avx512)
+    {
+      copy_avx512<sizeof(T)>(&dst, &src);
+      return;
+    }
+  }
 
-    uint8_t const current_version = slot.version.load(std::memory_order_relaxed);
-    slot.version.store(current_version + 1, std::memory_order_release);
-    std::atomic_signal_fence(std::memory_order_acq_rel);
+  if constexpr ((sizeof(T) >= VECTOR_COPY_MIN_SIZE) && (sizeof(T) < AVX2_COPY_MAX_SIZE))
+  {
+    if (level == SimdLevel::Avx2)
+    {
+      copy_avx2<sizeof(T)>(&dst, &src);
+      return;
+    }
+  }
+#endif
+
+  dst = src;
+}
 
-    slot.value = value;
+/**
+ * The low bits of a slot version are flags, the sequence of the message is stored above them
+ */
+constexpr uint64_t VERSION_WRITING{1u};
 
-    std::atomic_signal_fence(std::memory_order_acq_rel);
-    slot.version.store(current_version + 2, std::memory_order_release);
+// The message is followed by more messages of the same group
+constexpr uint64_t VERSION_GROUP_CONTINUES{2u};
+
+// The message is not the first message of its group
+constexpr uint64_t VERSION_GROUP_CONTINUATION{4u};
+
+constexpr uint64_t VERSION_GROUP_FLAGS{VERSION_GROUP_CONTINUES | VERSION_GROUP_CONTINUATION};
+constexpr uint32_t VERSION_SEQUENCE_SHIFT{3u};
+
+/***/
+constexpr uint64_t published_version(uint64_t sequence) noexcept
+{
+  return (sequence + 1u) << VERSION_SEQUENCE_SHIFT;
+}
+
+/***/
+constexpr uint64_t writing_version(uint64_t sequence) noexcept
+{
+  return published_version(sequence) | VERSION_WRITING;
+}
+
+/**
+ * @return the sequence of the message that follows the one with the given version
+ */
+constexpr uint64_t next_sequence(uint64_t version) noexcept { return version >> VERSION_SEQUENCE_SHIFT; }
+
+/**
+ * Counts the consecutive published messages starting at sequence `index`, up to max_count. Each
+ * version sits in its own slot, a cache line apart, so gathering them with vector loads is no
+ * faster than this loop
+ */
+template <typename TSlot>
+size_t published_run(TSlot const* slots, size_t mask, uint64_t index, size_t max_count) noexcept
+{
+  size_t run{0};
+
+  while ((run < max_count) &&
+         ((slots[(index + run) & mask].version.load(std::memory_order_acquire) & ~VERSION_GROUP_FLAGS) ==
+          published_version(index + run)))
+  {
+    ++run;
   }
 
-private:
-  slot_t* _slots{nullptr};
-  size_t _capacity{0};
-  size_t _mask{0};
-  size_t _write_index{0};
-};
+  return run;
+}
 
 /***/
-template <typename TBoundedSeqlockQueue>
-class SeqlockQueueConsumer
+inline void cpu_pause() noexcept
 {
-public:
-  using value_t = typename TBoundedSeqlockQueue::value_t;
-  using slot_t = typename TBoundedSeqlockQueue::slot_t;
+#if defined(SEQLOCK_QUEUE_X86_64)
+  _mm_pause();
+#else
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
 
-  SeqlockQueueConsumer(SeqlockQueueConsumer const&) = delete;
-  SeqlockQueueConsumer& operator=(SeqlockQueueConsumer const&) = delete;
-  SeqlockQueueConsumer(SeqlockQueueConsumer&&) = delete;
-  SeqlockQueueConsumer& operator=(SeqlockQueueConsumer&&) = delete;
+/**
+ * The read position a lossless consumer publishes for the producer, on its own cache line
+ */
+struct alignas(CACHE_ALIGNED) GatingCursor
+{
+  static constexpr uint64_t unused = std::numeric_limits<uint64_t>::max();
 
-  explicit SeqlockQueueConsumer(TBoundedSeqlockQueue& bounded_seqlock_queue)
-    : _slots(bounded_seqlock_queue._slots),
-      _capacity(bounded_seqlock_queue._capacity),
-      _mask(bounded_seqlock_queue._mask)
+  // Sequence of the next message the registered consumer will read
+  std::atomic<uint64_t> sequence{unused};
+};
+
+/**
+ * The limit up to which the producer writes before it looks at the gating cursors again. It is
+ * published for lossless consumers that register meanwhile, the producer does not see their cursor
+ * before it reaches the limit.
+ */
+struct alignas(CACHE_ALIGNED) GatingLimit
+{
+  // Odd while the producer computes a new limit
+  std::atomic<uint64_t> generation{0};
+  std::atomic<uint64_t> limit{0};
+};
+
+/**
+ * The bit of a ring in a ReadySet, which the producer of the ring sets after each write
+ */
+struct ReadyBit
+{
+  void mark() const noexcept
   {
+    // Orders the message before the check of the bit. A consumer clearing the bit at the same time
+    // then sees the message when it reads the ring, even when the bit is not set again here
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // While the bit is still set the shared line is only read
+    if (word->load(std::memory_order_relaxed) & word_bit)
+    {
+      return;
+    }
+
+    word->fetch_or(word_bit, std::memory_order_seq_cst);
+
+    if (!(summary->load(std::memory_order_seq_cst) & summary_bit))
+    {
+      summary->fetch_or(summary_bit, std::memory_order_seq_cst);
+    }
   }
 
-  /**
-   * Non blocking read.
-   * @param result
-   * @return true if successfully read, false otherwise
-   */
-  bool try_read(value_t& result) noexcept
+  std::atomic<uint64_t>* word{nullptr};
+  std::atomic<uint64_t>* summary{nullptr};
+  uint64_t word_bit{0};
+  uint64_t summary_bit{0};
+};
+
+/**
+ * How the producer wakes a consumer that waits on a notifier, e.g. an EventNotifier
+ */
+struct Waiter
+{
+  void wake_if_armed() const noexcept
+  {
+    // Orders the message before the check of armed. Without a full fence here, the consumer
+    // makes up for it with a process wide barrier when it arms the notifier
+    if (full_fence)
+    {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+    else
+    {
+      std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+
+    if (armed->load(std::memory_order_relaxed))
+    {
+      wake(context);
+    }
+  }
+
+  std::atomic<uint32_t> const* armed{nullptr};
+  void (*wake)(void*) noexcept {nullptr};
+  void* context{nullptr};
+  bool full_fence{true};
+};
+
+/**
+ * @return the slowest registered gating sequence or GatingCursor::unused when none is registered
+ */
+inline uint64_t min_gating_sequence(GatingCursor const* cursors, size_t count) noexcept
+{
+  uint64_t min_sequence = GatingCursor::unused;
+
+  for (size_t i = 0; i < count; ++i)
   {
-    size_t const index = _read_index & _mask;
-    slot_t const& slot = _slots[index];
+    uint64_t const sequence = cursors[i].sequence.load(std::memory_order_acquire);
+    min_sequence = sequence < min_sequence ? sequence : min_sequence;
+  }
 
-    uint8_t const version_1 = slot.version.load(std::memory_order_acquire);
-    std::atomic_signal_fence(std::memory_order_acq_rel);
+  return min_sequence;
+}
 
-    result = slot.value;
+/**
+ * Moves a gating cursor to sequence, or later when the producer can overwrite the message at
+ * sequence before it looks at the cursor again
+ * @param sequence updated to the sequence the cursor was moved to
+ */
+inline void move_gating_cursor(GatingCursor& cursor, GatingLimit const& gating_limit, size_t capacity,
+                               uint64_t& sequence) noexcept
+{
+  cursor.sequence.store(sequence, std::memory_order_relaxed);
 
-    std::atomic_signal_fence(std::memory_order_acq_rel);
-    uint8_t const version_2 = slot.version.load(std::memory_order_acquire);
+  // Either the producer sees the cursor when it computes its next limit, or this sees that limit
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  uint64_t generation;
+  uint64_t limit;
+
+  while (true)
+  {
+    generation = gating_limit.generation.load(std::memory_order_acquire);
+    limit = gating_limit.limit.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
 
-    if ((version_1 != version_2) || (version_1 & 1)) [[unlikely]]
+    if (!(generation & 1) && (gating_limit.generation.load(std::memory_order_relaxed) == generation))
     {
-      // This can only happen when the producer catches up with the consumer and tries to
-      // overwrite the slot
-      return false;
+      break;
+    }
+
+    cpu_pause();
+  }
+
+  // Until it reaches the limit the producer can overwrite the messages of the lap before it
+  if ((limit > capacity) && (sequence < limit - capacity))
+  {
+    sequence = limit - capacity;
+    cursor.sequence.store(sequence, std::memory_order_release);
+  }
+}
+
+/**
+ * Registers a free gating cursor at sequence, see move_gating_cursor
+ * @return the cursor, nullptr when all are in use
+ */
+inline GatingCursor* register_gating_cursor(GatingCursor* cursors, size_t count, GatingLimit const& gating_limit,
+                                            size_t capacity, uint64_t& sequence) noexcept
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    uint64_t unused = GatingCursor::unused;
+    if (cursors[i].sequence.compare_exchange_strong(unused, sequence))
+    {
+      move_gating_cursor(cursors[i], gating_limit, capacity, sequence);
+      return cursors + i;
     }
+  }
+
+  return nullptr;
+}
+
+/**
+ * Finds the sequence the producer writes next with a binary search over the slot versions. Slot 0
+ * and the slots after it up to the newest message hold the current lap, the rest hold the previous
+ * lap or were trimmed. When the producer is writing concurrently the result may already be behind.
+ * @param trim_write_index the write index of the producer at its last trim, only needed when both
+ * the first and the last slot were trimmed
+ */
+template <typename TSlot>
+uint64_t find_write_index(TSlot const* slots, size_t capacity, uint64_t trim_write_index) noexcept
+{
+  // The sequence that follows the message in the slot, 0 for a slot without a message
+  auto const next = [slots](size_t index)
+  { return next_sequence(slots[index].version.load(std::memory_order_acquire)); };
 
-    constexpr uint8_t limit = std::numeric_limits<typename decltype(slot.version)::value_type>::max() - 1;
-    uint8_t const version_diff = version_1 - _read_version;
+  size_t const last = capacity - 1;
+  size_t base{0};
+  uint64_t base_next = next(0);
 
-    if (version_diff >= limit)
+  if (base_next == 0)
+  {
+    // Slot 0 was never written or was trimmed. Trimmed slots are the ones after the newest message
+    if (uint64_t const last_next = next(last); last_next != 0)
     {
-      // when the version wraps we will have e.g. for capacity 4
-      // 0 0 254 254
-      // version_2 will be 254 for the slot at index 2 when reading here
-      // _read_version will be 0
-      // we do not want to read 254 as we already read it earlier before version wrapped around
+      return last_next;
+    }
 
-      // This also ensures that we won't be reading the values twice, eg :
-      // version_1 is 10;
-      // _read_version is 12 after reading the whole queue and wrapping
-      // publisher never wrote something new to the start of the queue
-      // version_1 - _read_version will give 254
-      return false;
+    // The newest message is somewhere after the slot the producer had reached when trimming
+    base = trim_write_index & last;
+    base_next = next(base);
+
+    if (base_next != trim_write_index + 1)
+    {
+      return trim_write_index;
     }
+  }
+
+  // The last slot that holds the message expected in the same lap as the base slot
+  size_t low{base};
+  size_t high{capacity};
+
+  while (high - low > 1)
+  {
+    size_t const middle = low + (high - low) / 2;
 
-    // When we have read all items for the queue we will wrap around, we need to increment
-    // the reader version
-    if (index == 0)
+    if (next(middle) == base_next + (middle - base))
     {
-      _read_version = version_2;
+      low = middle;
     }
-    else if ((index + 1) == _capacity)
+    else
     {
-      _read_version = version_2 + 2;
+      high = middle;
     }
+  }
 
-    ++_read_index;
+  return base_next + (low - base);
+}
 
-    return true;
+/**
+ * Finds the sequence the producer writes next, see above. A trim that resets slots during the
+ * search can hide the newest messages from it, but the trim publishes its write index before it
+ * resets any slot, so that index is loaded again after the search.
+ */
+template <typename TSlot>
+uint64_t find_write_index(TSlot const* slots, size_t capacity, std::atomic<uint64_t> const& trim_write_index) noexcept
+{
+  uint64_t const write_index = find_write_index(slots, capacity, trim_write_index.load(std::memory_order_acquire));
+  return std::max(write_index, trim_write_index.load(std::memory_order_acquire));
+}
+
+/**
+ * Finds the oldest message still in the queue with a binary search over the slot versions. The
+ * messages before it were trimmed or never written.
+ * @return the sequence of the oldest message, write_index when there is none
+ */
+template <typename TSlot>
+uint64_t find_oldest_sequence(TSlot const* slots, size_t capacity, uint64_t write_index) noexcept
+{
+  uint64_t low = write_index > capacity ? write_index - capacity : 0;
+  uint64_t high{write_index};
+
+  // The first sequence whose slot holds that message, or a newer one when it was just overwritten
+  while (low < high)
+  {
+    uint64_t const middle = low + (high - low) / 2;
+
+    if (next_sequence(slots[middle & (capacity - 1)].version.load(std::memory_order_acquire)) > middle)
+    {
+      high = middle;
+    }
+    else
+    {
+      low = middle + 1;
+    }
   }
 
-private:
+  return low;
+}
+
+/**
+ * The clock of Timestamped queues
+ */
+inline uint64_t steady_clock_ns() noexcept
+{
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count());
+}
+
+/**
+ * Timestamp counter used by the instrumentation, falls back to nanoseconds
+ */
+inline uint64_t rdtsc() noexcept
+{
+#if defined(SEQLOCK_QUEUE_CPU_DISPATCH)
+  return __builtin_ia32_rdtsc();
+#else
+  return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/***/
+inline void prefetch_line(void const* address) noexcept
+{
+#if defined(SEQLOCK_QUEUE_X86_64)
+  _mm_prefetch(static_cast<char const*>(address), _MM_HINT_T0);
+#elif defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(address, 0, 3);
+#endif
+}
+
+/**
+ * Prefetches every cache line of a slot. When ForWrite is set the lines are requested in exclusive
+ * state (prefetchw), which saves the read for ownership when the slot is written later
+ */
+template <bool ForWrite, typename TSlot>
+void prefetch_slot(TSlot const* slot) noexcept
+{
+  auto const* address = reinterpret_cast<char const*>(slot);
+
+  for (size_t offset = 0; offset < sizeof(TSlot); offset += CACHE_ALIGNED)
+  {
+#if defined(SEQLOCK_QUEUE_CPU_DISPATCH)
+    if constexpr (ForWrite)
+    {
+      // prefetchw executes as a nop on the processors that do not support it
+      asm volatile("prefetchw %0" : : "m"(*(address + offset)));
+    }
+    else
+    {
+      __builtin_prefetch(address + offset, 0, 3);
+    }
+#elif defined(SEQLOCK_QUEUE_X86_64)
+    _mm_prefetch(address + offset, _MM_HINT_T0);
+#elif defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address + offset, ForWrite ? 1 : 0, 3);
+#endif
+  }
+}
+
+/**
+ * @param bits must not be 0
+ * @return the index of the lowest set bit
+ */
+inline uint32_t count_trailing_zeros(uint64_t bits) noexcept
+{
+  assert(bits != 0);
+
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<uint32_t>(__builtin_ctzll(bits));
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+  unsigned long index;
+  _BitScanForward64(&index, bits);
+  return static_cast<uint32_t>(index);
+#else
+  uint32_t count{0};
+  while (!(bits & 1u))
+  {
+    bits >>= 1u;
+    ++count;
+  }
+  return count;
+#endif
+}
+} // namespace sq::detail
+
+namespace sq
+{
+template <typename T, size_t Alignment, bool Tagged = false, bool Timestamped = false>
+struct alignas(Alignment) Slot
+{
+  static_assert(std::is_trivially_copyable<T>::value, "T needs to be trivially copyable");
+
+  static constexpr bool tagged = false;
+  static constexpr bool timestamped = false;
+
+  T value;
+
+  // (sequence + 1) << 3 once the message with that sequence is published, with the group flags in
+  // bits 1 and 2, and odd while it is being written. A slot that was never written, or was trimmed,
+  // has version 0. The version takes 8 bytes, so with the default alignment a value of up to 56
+  // bytes fits a 64 byte slot, while 57 to 64 byte values need a 128 byte slot
+  std::atomic<uint64_t> version{0};
+};
+
+/**
+ * A slot with a tag set by the producer next to the version, so consumers can filter messages
+ * without reading the value
+ */
+template <typename T, size_t Alignment>
+struct alignas(Alignment) Slot<T, Alignment, true, false>
+{
+  static_assert(std::is_trivially_copyable<T>::value, "T needs to be trivially copyable");
+
+  static constexpr bool tagged = true;
+  static constexpr bool timestamped = false;
+
+  T value;
+  std::atomic<uint64_t> version{0};
+
+  // Written while the version is odd, like the value
+  std::atomic<uint64_t> tag{0};
+};
+
+/**
+ * A slot stamped by the producer with the time of the write, so consumers can search the queue by
+ * time
+ */
+template <typename T, size_t Alignment>
+struct alignas(Alignment) Slot<T, Alignment, false, true>
+{
+  static_assert(std::is_trivially_copyable<T>::value, "T needs to be trivially copyable");
+
+  static constexpr bool tagged = false;
+  static constexpr bool timestamped = true;
+
+  T value;
+  std::atomic<uint64_t> version{0};
+
+  // Written while the version is odd, like the value
+  std::atomic<uint64_t> timestamp{0};
+};
+
+/***/
+template <typename T, size_t Alignment>
+struct alignas(Alignment) Slot<T, Alignment, true, true>
+{
+  static_assert(std::is_trivially_copyable<T>::value, "T needs to be trivially copyable");
+
+  static constexpr bool tagged = true;
+  static constexpr bool timestamped = true;
+
+  T value;
+  std::atomic<uint64_t> version{0};
+  std::atomic<uint64_t> tag{0};
+  std::atomic<uint64_t> timestamp{0};
+};
+
+/**
+ * Predicate for the filtered reads that accepts the tags sharing a bit with the mask
+ */
+struct TagMask
+{
+  uint64_t mask;
+
+  constexpr bool operator()(uint64_t tag) const noexcept { return (tag & mask) != 0; }
+};
+
+/**
+ * What a producer does when a lossless consumer has not read the slot it is about to overwrite
+ */
+enum class WaitStrategy : uint8_t
+{
+  Spin,
+  Yield
+};
+
+/***/
+enum class ConsumerMode : uint8_t
+{
+  // The consumer may be lapped by the producer and drop messages
+  Lossy,
+  // The consumer publishes its read position and the producer never overwrites a message it has
+  // not read yet
+  Lossless
+};
+
+/**
+ * Where a consumer starts reading, as a number of messages already in the queue before the
+ * producer's current position
+ */
+struct StartPosition
+{
+  // The oldest message that is still in the queue
+  static constexpr StartPosition oldest() noexcept
+  {
+    return StartPosition{std::numeric_limits<uint64_t>::max()};
+  }
+
+  // Only the messages written from now on
+  static constexpr StartPosition latest() noexcept { return StartPosition{0}; }
+
+  // The last `count` messages written, or from the oldest message when there are fewer
+  static constexpr StartPosition before_latest(uint64_t count) noexcept { return StartPosition{count}; }
+
+  uint64_t backlog;
+};
+
+/***/
+enum class ReadResult : uint8_t
+{
+  Success,
+  // There is no new message
+  Empty,
+  // The producer is writing the slot of the next message
+  Busy,
+  // The message was overwritten by a newer one or trimmed
+  Overwritten
+};
+
+/**
+ * Collected when SEQLOCK_QUEUE_INSTRUMENTATION is defined
+ */
+struct ProducerStats
+{
+  uint64_t writes{0};
+
+  // ticks between the odd and the even version store, the time a slot can not be read
+  uint64_t locked_ticks{0};
+  uint64_t max_locked_ticks{0};
+};
+
+/**
+ * Collected when SEQLOCK_QUEUE_INSTRUMENTATION is defined
+ */
+struct ConsumerStats
+{
+  uint64_t reads{0};
+
+  // reads that failed because the producer was writing the slot
+  uint64_t torn_reads{0};
+};
+
+/**
+ * @tparam Tagged when set, every slot stores a tag next to its version, see try_read_if
+ * @tparam Timestamped when set, every slot stores the time it was written, see seek_timestamp
+ */
+template <typename T, size_t SlotAlignment = detail::CACHE_ALIGNED, size_t CacheAligned = detail::CACHE_ALIGNED,
+          bool Tagged = false, bool Timestamped = false>
+class BoundedSeqlockQueue
+{
+public:
+  using value_t = T;
+  using slot_t = Slot<value_t, SlotAlignment, Tagged, Timestamped>;
+
+  BoundedSeqlockQueue(BoundedSeqlockQueue const&) = delete;
+  BoundedSeqlockQueue& operator=(BoundedSeqlockQueue const&) = delete;
+  BoundedSeqlockQueue(BoundedSeqlockQueue&&) = delete;
+  BoundedSeqlockQueue& operator=(BoundedSeqlockQueue&&) = delete;
+
+  /**
+   * @param capacity
+   * @param huge_pages
+   * @param max_lossless_consumers the number of ConsumerMode::Lossless consumers that can be
+   * registered at the same time. When zero, the producer never waits for a consumer
+   */
+  BoundedSeqlockQueue(size_t capacity, bool huge_pages = false, size_t max_lossless_consumers = 0)
+    : _capacity(detail::next_power_of_2(capacity)),
+      _mask(_capacity - 1),
+      _page_size(detail::page_size(huge_pages)),
+      _gating_cursor_count(max_lossless_consumers)
+  {
+    // Construct in place the objects
+    _slots = static_cast<slot_t*>(detail::alloc_aligned(sizeof(slot_t) * _capacity, CacheAligned, huge_pages));
+
+    for (uint64_t i = 0; i < _capacity; ++i)
+    {
+      new (_slots + i) slot_t{};
+    }
+
+    if (_gating_cursor_count != 0)
+    {
+      _gating_cursors = static_cast<detail::GatingCursor*>(detail::alloc_aligned(
+        sizeof(detail::GatingCursor) * _gating_cursor_count, detail::CACHE_ALIGNED, false));
+
+      for (uint64_t i = 0; i < _gating_cursor_count; ++i)
+      {
+        new (_gating_cursors + i) detail::GatingCursor{};
+      }
+    }
+  };
+
+  ~BoundedSeqlockQueue()
+  {
+    detail::free_aligned(_slots);
+
+    if (_gating_cursors)
+    {
+      detail::free_aligned(_gating_cursors);
+    }
+  }
+
+  template <typename, size_t>
+  friend class SeqlockQueueProducer;
+
+  template <typename, bool>
+  friend class SeqlockQueueConsumer;
+
+  template <typename>
+  friend class SeqlockQueueStage;
+
+private:
+  slot_t* _slots{nullptr};
+  size_t _capacity{0};
+  size_t _mask{0};
+  size_t _page_size{0};
+  detail::GatingCursor* _gating_cursors{nullptr};
+  size_t _gating_cursor_count{0};
+
+  // The write index of the producer at its last trim, consumers look it up to find their start
+  // position when the slots around it were trimmed
+  mutable std::atomic<uint64_t> _trim_write_index{0};
+
+  // The oldest message the last trim retained, consumers behind it continue from there
+  mutable std::atomic<uint64_t> _trim_oldest{0};
+
+  mutable detail::GatingLimit _gating_limit;
+};
+
+/**
+ * @tparam PrefetchDistance when not zero, each write prefetches for writing the slot that many
+ * messages ahead, so that the producer does not take a cache miss on its critical path when it
+ * reaches it. Should be well below the capacity of the queue.
+ */
+template <typename TBoundedSeqlockQueue, size_t PrefetchDistance = 0>
+class SeqlockQueueProducer
+{
+public:
+  using value_t = typename TBoundedSeqlockQueue::value_t;
+  using slot_t = typename TBoundedSeqlockQueue::slot_t;
+
+  SeqlockQueueProducer(SeqlockQueueProducer const&) = delete;
+  SeqlockQueueProducer& operator=(SeqlockQueueProducer const&) = delete;
+  SeqlockQueueProducer(SeqlockQueueProducer&&) = delete;
+  SeqlockQueueProducer& operator=(SeqlockQueueProducer&&) = delete;
+
+  /**
+   * @param bounded_seqlock_queue
+   * @param wait_strategy how write() waits for lossless consumers to make room
+   */
+  explicit SeqlockQueueProducer(TBoundedSeqlockQueue const& bounded_seqlock_queue,
+                                WaitStrategy wait_strategy = WaitStrategy::Spin)
+    : _slots(bounded_seqlock_queue._slots),
+      _capacity(bounded_seqlock_queue._capacity),
+      _mask(bounded_seqlock_queue._mask),
+      _page_size(bounded_seqlock_queue._page_size),
+      _gating_cursors(bounded_seqlock_queue._gating_cursors),
+      _gating_cursor_count(bounded_seqlock_queue._gating_cursor_count),
+      _trim_write_index(&bounded_seqlock_queue._trim_write_index),
+      _trim_oldest(&bounded_seqlock_queue._trim_oldest),
+      _published_gating_limit(&bounded_seqlock_queue._gating_limit),
+      _gating_limit(_gating_cursor_count == 0 ? std::numeric_limits<uint64_t>::max() : 0),
+      _wait_strategy(wait_strategy),
+      _atomic_16b(detail::is_packed_slot_v<slot_t> && detail::has_atomic_16b_access()),
+      _simd_level(detail::simd_level())
+  {
+  }
+
+  /**
+   * @param callback fills the value in place
+   * @param tag stored with the message when the queue is Tagged, ignored otherwise
+   */
+  template <typename T>
+  void write(T callback, uint64_t tag = 0) noexcept
+  {
+    wait_for_room();
+    prefetch_ahead();
+
+    slot_t& slot = _slots[_write_index & _mask];
+
+    uint64_t const sequence = _write_index++;
+
+    if constexpr (detail::is_packed_slot_v<slot_t>)
+    {
+      if (_atomic_16b)
+      {
+        // The value and the version are published together with a single store, which is all the
+        // time the slot is locked for
+        value_t value = slot.value;
+        callback(value);
+        [[maybe_unused]] uint64_t const lock_start = lock_started();
+        detail::store_packed(&slot, value, detail::published_version(sequence));
+        lock_released(lock_start);
+        notify_published();
+        return;
+      }
+    }
+
+    slot.version.store(detail::writing_version(sequence), std::memory_order_release);
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+    [[maybe_unused]] uint64_t const lock_start = lock_started();
+    store_header(slot, tag, message_timestamp());
+
+    callback(slot.value);
+
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+    slot.version.store(detail::published_version(sequence), std::memory_order_release);
+    lock_released(lock_start);
+    notify_published();
+  }
+
+  /**
+   * Like write(callback), but fails instead of waiting when a lossless consumer has not read the
+   * slot yet.
+   * @return true if written, false if the queue is full
+   */
+  template <typename T>
+  bool try_write(T callback, uint64_t tag = 0) noexcept
+  {
+    if (!has_room())
+    {
+      return false;
+    }
+
+    write(callback, tag);
+    return true;
+  }
+
+  /**
+   * Like write(value), but fails instead of waiting when a lossless consumer has not read the
+   * slot yet.
+   * @return true if written, false if the queue is full
+   */
+  bool try_write(value_t const& value, uint64_t tag = 0) noexcept
+  {
+    if (!has_room())
+    {
+      return false;
+    }
+
+    write(value, tag);
+    return true;
+  }
+
+  /**
+   * Like write(callback), but the callback fills a thread local staging value and the slot is only
+   * locked while the finished value is copied into it. Use this when the callback does more than
+   * a few stores, so that consumers reaching the slot do not fail with a torn read for as long as
+   * the callback runs.
+   */
+  template <typename T>
+  void write_staged(T callback, uint64_t tag = 0) noexcept
+  {
+    alignas(slot_t) static thread_local value_t staging{};
+
+    callback(staging);
+    write(staging, tag);
+  }
+
+  /**
+   * @param value
+   * @param tag stored with the message when the queue is Tagged, ignored otherwise
+   */
+  void write(value_t const& value, uint64_t tag = 0) noexcept
+  {
+    wait_for_room();
+    prefetch_ahead();
+
+    slot_t& slot = _slots[_write_index & _mask];
+
+    uint64_t const sequence = _write_index++;
+
+    if constexpr (detail::is_packed_slot_v<slot_t>)
+    {
+      if (_atomic_16b)
+      {
+        [[maybe_unused]] uint64_t const lock_start = lock_started();
+        detail::store_packed(&slot, value, detail::published_version(sequence));
+        lock_released(lock_start);
+        notify_published();
+        return;
+      }
+    }
+
+    slot.version.store(detail::writing_version(sequence), std::memory_order_release);
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+    [[maybe_unused]] uint64_t const lock_start = lock_started();
+    store_header(slot, tag, message_timestamp());
+
+    detail::copy_value(slot.value, value, _simd_level);
+
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+    slot.version.store(detail::published_version(sequence), std::memory_order_release);
+    lock_released(lock_start);
+    notify_published();
+  }
+
+  /**
+   * Publishes count messages as one group: a consumer reading with try_read_group receives either
+   * none or all of them. All the slots of the group are locked first and then published from the
+   * last to the first, so once the first message of the group is visible the rest already is.
+   * Consumers using try_read or try_read_batch receive the messages of a group one by one.
+   * @param values array of count values
+   * @param count the number of messages in the group, at most the capacity of the queue
+   * @param tag stored with every message of the group when the queue is Tagged
+   */
+  void write_group(value_t const* values, size_t count, uint64_t tag = 0) noexcept
+  {
+    assert((count <= _capacity) && "a group can not be larger than the queue");
+
+    if (count == 0)
+    {
+      return;
+    }
+
+    wait_for_room(count);
+
+    uint64_t const first = _write_index;
+    _write_index += count;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      _slots[(first + i) & _mask].version.store(detail::writing_version(first + i), std::memory_order_release);
+    }
+
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+    [[maybe_unused]] uint64_t const lock_start = lock_started();
+
+    // The whole group is stamped with the same time
+    uint64_t const timestamp = message_timestamp();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      store_header(_slots[(first + i) & _mask], tag, timestamp);
+      detail::copy_value(_slots[(first + i) & _mask].value, values[i], _simd_level);
+    }
+
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+
+    for (size_t i = count; i-- > 0;)
+    {
+      uint64_t version = detail::published_version(first + i);
+      version |= (i + 1 != count) ? detail::VERSION_GROUP_CONTINUES : 0;
+      version |= (i != 0) ? detail::VERSION_GROUP_CONTINUATION : 0;
+      _slots[(first + i) & _mask].version.store(version, std::memory_order_release);
+    }
+
+    lock_released(lock_start, count);
+    notify_published();
+  }
+
+  /**
+   * Like write_group, but fails instead of waiting when a lossless consumer has not read the slots
+   * yet.
+   * @return true if written, false if the queue does not have room for the whole group
+   */
+  bool try_write_group(value_t const* values, size_t count, uint64_t tag = 0) noexcept
+  {
+    if (!has_room(count))
+    {
+      return false;
+    }
+
+    write_group(values, count, tag);
+    return true;
+  }
+
+  /**
+   * Writes the value with non temporal stores, for producers that never read back what they
+   * write. The slot lines are not read for ownership and do not evict the producer's working set
+   * from its cache. The default write is faster when the consumer reads the slot while it is still
+   * in the producer's cache.
+   */
+  void write_non_temporal(value_t const& value, uint64_t tag = 0) noexcept
+  {
+#if defined(SEQLOCK_QUEUE_X86_64)
+    static_assert(alignof(slot_t) >= 16u, "non temporal writes require a SlotAlignment of at least 16");
+
+    wait_for_room();
+
+    slot_t& slot = _slots[_write_index & _mask];
+
+    uint64_t const sequence = _write_index++;
+    slot.version.store(detail::writing_version(sequence), std::memory_order_release);
+
+    // Non temporal stores are not ordered with the other stores. The odd version has to be visible
+    // before any part of the value and the whole value before the even version
+    _mm_sfence();
+    [[maybe_unused]] uint64_t const lock_start = lock_started();
+    store_header(slot, tag, message_timestamp());
+
+    detail::stream_copy<sizeof(value_t)>(&slot.value, &value);
+
+    _mm_sfence();
+    slot.version.store(detail::published_version(sequence), std::memory_order_release);
+    lock_released(lock_start);
+    notify_published();
+#else
+    write(value, tag);
+#endif
+  }
+
+  /**
+   * Sets the bit of this queue in a ReadySet after every write from now on, so that a consumer of
+   * many queues only visits the ones with new messages. Each write then costs a fence and a load
+   * of the shared bitmap, plus an atomic or when the consumer has cleared the bit.
+   * @param ready_set a ReadySet that outlives the producer
+   * @param ring the index of this queue in the ready set
+   */
+  template <typename TReadySet>
+  void set_ready_set(TReadySet& ready_set, size_t ring)
+  {
+    _ready_bit = ready_set.ready_bit(ring);
+  }
+
+  /**
+   * Wakes the consumer waiting on the notifier after a write, once the consumer has armed it.
+   * While it is not armed each write costs one load of the armed flag.
+   * @param notifier e.g. an EventNotifier that outlives the producer
+   */
+  template <typename TNotifier>
+  void set_notifier(TNotifier& notifier)
+  {
+    _waiter = notifier.waiter();
+  }
+
+  /**
+   * Returns the memory of the slots that do not hold one of the last `retain` messages to the OS,
+   * e.g. when the queue is idle. Only whole pages are released, so for small queues or
+   * a large `retain` nothing may be released.
+   *
+   * The trimmed slots are reset to the never written state before their pages are released, so
+   * they read back as empty rather than as stale or torn messages. A consumer that was positioned
+   * on a trimmed message continues with the oldest retained one.
+   *
+   * Must be called from the producer thread.
+   * @param retain number of most recent messages that stay resident
+   * @return the number of bytes released
+   */
+  size_t trim(size_t retain = 0) noexcept
+  {
+    // Messages that lossless consumers did not read yet are always retained
+    uint64_t const min_gating_sequence = detail::min_gating_sequence(_gating_cursors, _gating_cursor_count);
+
+    if ((min_gating_sequence != detail::GatingCursor::unused) && (_write_index - min_gating_sequence > retain))
+    {
+      retain = _write_index - min_gating_sequence;
+    }
+
+    if (retain >= _capacity)
+    {
+      return 0;
+    }
+
+    // The oldest messages, the ones the producer will overwrite next, start at the write index
+    size_t const first = _write_index & _mask;
+    size_t const count = _capacity - retain;
+
+    // Published before any slot is reset, so a reader that sees a trimmed slot also sees where the
+    // retained messages start rather than the indices of the previous trim
+    _trim_oldest->store(_write_index - std::min<uint64_t>(_write_index, retain), std::memory_order_release);
+    _trim_write_index->store(_write_index, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      slot_t& slot = _slots[(first + i) & _mask];
+
+      // Only touch slots that are not already empty, to not fault released pages back in
+      if (slot.version.load(std::memory_order_relaxed) != 0)
+      {
+        slot.version.store(0, std::memory_order_release);
+      }
+    }
+
+    if (first + count <= _capacity)
+    {
+      return detail::release_pages(_slots + first, _slots + first + count, _page_size);
+    }
+
+    // The trimmed range wraps around the end of the ring
+    return detail::release_pages(_slots + first, _slots + _capacity, _page_size) +
+      detail::release_pages(_slots, _slots + (first + count - _capacity), _page_size);
+  }
+
+#if defined(SEQLOCK_QUEUE_INSTRUMENTATION)
+  ProducerStats const& stats() const noexcept { return _stats; }
+#endif
+
+private:
+  /**
+   * The slowest lossless consumer is only looked up again once the write index reaches the
+   * position it allowed at the last look up, which is at most once per lap
+   * @param count the number of messages that are about to be written
+   */
+  bool has_room(size_t count = 1) noexcept
+  {
+    if (_write_index + count <= _gating_limit) [[likely]]
+    {
+      return true;
+    }
+
+    uint64_t const generation = _published_gating_limit->generation.load(std::memory_order_relaxed);
+    _published_gating_limit->generation.store(generation + 1, std::memory_order_relaxed);
+
+    // Either a consumer registering now sees the new limit, or its cursor is seen here
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    uint64_t const min_gating_sequence = detail::min_gating_sequence(_gating_cursors, _gating_cursor_count);
+
+    // Without registered lossless consumers look again in one lap, to notice new registrations
+    _gating_limit =
+      (min_gating_sequence == detail::GatingCursor::unused ? _write_index : min_gating_sequence) + _capacity;
+
+    _published_gating_limit->limit.store(_gating_limit, std::memory_order_relaxed);
+    _published_gating_limit->generation.store(generation + 2, std::memory_order_release);
+
+    return _write_index + count <= _gating_limit;
+  }
+
+  void notify_published() const noexcept
+  {
+    if (_ready_bit.word)
+    {
+      _ready_bit.mark();
+    }
+
+    if (_waiter.armed)
+    {
+      _waiter.wake_if_armed();
+    }
+  }
+
+  void wait_for_room(size_t count = 1) noexcept
+  {
+    while (!has_room(count))
+    {
+      if (_wait_strategy == WaitStrategy::Yield)
+      {
+        std::this_thread::yield();
+      }
+      else
+      {
+        detail::cpu_pause();
+      }
+    }
+  }
+
+  uint64_t lock_started() const noexcept
+  {
+#if defined(SEQLOCK_QUEUE_INSTRUMENTATION)
+    return detail::rdtsc();
+#else
+    return 0;
+#endif
+  }
+
+  void lock_released([[maybe_unused]] uint64_t lock_start, [[maybe_unused]] size_t count = 1) noexcept
+  {
+#if defined(SEQLOCK_QUEUE_INSTRUMENTATION)
+    uint64_t const locked_ticks = detail::rdtsc() - lock_start;
+    _stats.writes += count;
+    _stats.locked_ticks += locked_ticks;
+    _stats.max_locked_ticks = locked_ticks > _stats.max_locked_ticks ? locked_ticks : _stats.max_locked_ticks;
+#endif
+  }
+
+  static uint64_t message_timestamp() noexcept
+  {
+    if constexpr (slot_t::timestamped)
+    {
+      return detail::steady_clock_ns();
+    }
+    else
+    {
+      return 0;
+    }
+  }
+
+  static void store_header([[maybe_unused]] slot_t& slot, [[maybe_unused]] uint64_t tag,
+                           [[maybe_unused]] uint64_t timestamp) noexcept
+  {
+    if constexpr (slot_t::tagged)
+    {
+      slot.tag.store(tag, std::memory_order_relaxed);
+    }
+
+    if constexpr (slot_t::timestamped)
+    {
+      slot.timestamp.store(timestamp, std::memory_order_relaxed);
+    }
+  }
+
+  void prefetch_ahead() const noexcept
+  {
+    if constexpr (PrefetchDistance != 0)
+    {
+      detail::prefetch_slot<true>(_slots + ((_write_index + PrefetchDistance) & _mask));
+    }
+  }
+
+private:
+  slot_t* _slots{nullptr};
+  size_t _capacity{0};
+  size_t _mask{0};
+  size_t _page_size{0};
+  size_t _write_index{0};
+  detail::GatingCursor* _gating_cursors{nullptr};
+  size_t _gating_cursor_count{0};
+  std::atomic<uint64_t>* _trim_write_index{nullptr};
+  std::atomic<uint64_t>* _trim_oldest{nullptr};
+  detail::GatingLimit* _published_gating_limit{nullptr};
+  uint64_t _gating_limit{0};
+  detail::ReadyBit _ready_bit;
+  detail::Waiter _waiter;
+  WaitStrategy _wait_strategy{WaitStrategy::Spin};
+  bool _atomic_16b{false};
+  detail::SimdLevel _simd_level{detail::SimdLevel::Scalar};
+
+#if defined(SEQLOCK_QUEUE_INSTRUMENTATION)
+  ProducerStats _stats;
+#endif
+};
+
+/**
+ * @tparam PrefetchNext when set, each successful read prefetches the slot of the next message
+ */
+template <typename TBoundedSeqlockQueue, bool PrefetchNext = false>
+class SeqlockQueueConsumer
+{
+public:
+  using value_t = typename TBoundedSeqlockQueue::value_t;
+  using slot_t = typename TBoundedSeqlockQueue::slot_t;
+
+  SeqlockQueueConsumer(SeqlockQueueConsumer const&) = delete;
+  SeqlockQueueConsumer& operator=(SeqlockQueueConsumer const&) = delete;
+  SeqlockQueueConsumer(SeqlockQueueConsumer&&) = delete;
+  SeqlockQueueConsumer& operator=(SeqlockQueueConsumer&&) = delete;
+
+  /**
+   * @param bounded_seqlock_queue
+   * @param mode a Lossless consumer registers one of the gating cursors of the queue and throws
+   * when all of them are in use. It starts no earlier than the oldest message the producer can not
+   * overwrite before it sees the registration, which can be after start_position.
+   * @param start_position where to start reading, found in O(log capacity) from the slot versions
+   */
+  explicit SeqlockQueueConsumer(TBoundedSeqlockQueue& bounded_seqlock_queue, ConsumerMode mode = ConsumerMode::Lossy,
+                                StartPosition start_position = StartPosition::oldest())
+    : _slots(bounded_seqlock_queue._slots),
+      _capacity(bounded_seqlock_queue._capacity),
+      _mask(bounded_seqlock_queue._mask),
+      _trim_write_index(&bounded_seqlock_queue._trim_write_index),
+      _trim_oldest(&bounded_seqlock_queue._trim_oldest),
+      _gating_limit(&bounded_seqlock_queue._gating_limit),
+      _atomic_16b(detail::is_packed_slot_v<slot_t> && detail::has_atomic_16b_access()),
+      _simd_level(detail::simd_level())
+  {
+    _read_index = start_sequence(start_position);
+
+    if (mode == ConsumerMode::Lossless)
+    {
+      _gating_cursor = detail::register_gating_cursor(bounded_seqlock_queue._gating_cursors,
+                                                      bounded_seqlock_queue._gating_cursor_count,
+                                                      *_gating_limit, _capacity, _read_index);
+
+      if (!_gating_cursor)
+      {
+        throw std::runtime_error{"no gating cursor available for a lossless consumer"};
+      }
+    }
+  }
+
+  ~SeqlockQueueConsumer()
+  {
+    if (_saved_sequence)
+    {
+      _saved_sequence->store(_read_index, std::memory_order_release);
+    }
+
+    if (_gating_cursor)
+    {
+      _gating_cursor->sequence.store(detail::GatingCursor::unused, std::memory_order_release);
+    }
+  }
+
+  /**
+   * Moves the consumer to a new start position, e.g. to skip a backlog it does not need.
+   * @param start_position
+   */
+  void seek(StartPosition start_position) noexcept { move_to(start_sequence(start_position)); }
+
+  /**
+   * Reads the message with the given sequence, if it is still in the queue, without moving the
+   * consumer.
+   * @param sequence
+   * @param result
+   * @return Success, Empty when the message was not written yet, Busy when the producer is writing
+   * it, or Overwritten when it is no longer in the queue
+   */
+  ReadResult try_get(uint64_t sequence, value_t& result) const noexcept
+  {
+    slot_t const& slot = _slots[sequence & _mask];
+
+    if constexpr (detail::is_packed_slot_v<slot_t>)
+    {
+      if (_atomic_16b)
+      {
+        uint64_t const version = detail::load_packed(&slot, result);
+        return get_result(sequence, version, version);
+      }
+    }
+
+    uint64_t const version_1 = slot.version.load(std::memory_order_acquire);
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+
+    detail::copy_value(result, slot.value, _simd_level);
+
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+    uint64_t const version_2 = slot.version.load(std::memory_order_acquire);
+
+    return get_result(sequence, version_1, version_2);
+  }
+
+  /**
+   * Moves the consumer to the first message written at or after the given time, found with a
+   * binary search over the messages still in the queue. Messages the producer overwrites or trims
+   * during the search count as older. Requires a Timestamped queue.
+   * @param timestamp nanoseconds since the epoch of std::chrono::steady_clock
+   */
+  void seek_timestamp(uint64_t timestamp) noexcept
+  {
+    static_assert(slot_t::timestamped, "seek_timestamp requires a Timestamped queue");
+
+    uint64_t high = detail::find_write_index(_slots, _capacity, *_trim_write_index);
+    uint64_t low = detail::find_oldest_sequence(_slots, _capacity, high);
+
+    while (low < high)
+    {
+      uint64_t const middle = low + (high - low) / 2;
+      slot_t const& slot = _slots[middle & _mask];
+
+      uint64_t const version_1 = slot.version.load(std::memory_order_acquire);
+      std::atomic_signal_fence(std::memory_order_acq_rel);
+
+      uint64_t const slot_timestamp = slot.timestamp.load(std::memory_order_relaxed);
+
+      std::atomic_signal_fence(std::memory_order_acq_rel);
+      uint64_t const version_2 = slot.version.load(std::memory_order_acquire);
+
+      bool const before = (version_1 == version_2) && !(version_1 & detail::VERSION_WRITING)
+        ? (detail::next_sequence(version_1) != middle + 1) || (slot_timestamp < timestamp)
+        // A slot that no longer holds middle, because it is being written again or was reset by a
+        // trim, counts as older
+        : detail::next_sequence(version_2) != middle + 1;
+
+      if (before)
+      {
+        low = middle + 1;
+      }
+      else
+      {
+        high = middle;
+      }
+    }
+
+    move_to(low);
+  }
+
+  /**
+   * Continues from a sequence saved by a previous consumer, e.g. with save_position.
+   * @param sequence the next message to read
+   * @return Success when the consumer resumes at sequence, Overwritten when it is no longer in the
+   * queue and the consumer starts at the oldest message instead, or Empty when the queue did not
+   * reach sequence yet and the consumer is not moved
+   */
+  ReadResult resume(uint64_t sequence) noexcept
+  {
+    uint64_t const write_index =
+      detail::find_write_index(_slots, _capacity, *_trim_write_index);
+
+    if (sequence > write_index)
+    {
+      return ReadResult::Empty;
+    }
+
+    uint64_t const oldest = detail::find_oldest_sequence(_slots, _capacity, write_index);
+
+    if (sequence < oldest)
+    {
+      move_to(oldest);
+      return ReadResult::Overwritten;
+    }
+
+    // A lossless consumer can be moved past the messages the producer may overwrite meanwhile
+    move_to(sequence);
+    return _read_index == sequence ? ReadResult::Success : ReadResult::Overwritten;
+  }
+
+  /**
+   * Stores the position of the consumer to `sequence` every `interval` messages and when the
+   * consumer is destroyed, so that a consumer recreated on the same queue can resume it.
+   * @param sequence where the position is saved, nullptr to stop saving it
+   * @param interval
+   */
+  void save_position(std::atomic<uint64_t>* sequence, uint64_t interval) noexcept
+  {
+    _saved_sequence = sequence;
+    _save_interval = interval ? interval : 1;
+    _next_save = _saved_sequence ? _read_index : std::numeric_limits<uint64_t>::max();
+    save_position();
+  }
+
+  /**
+   * @return the sequence of the next message the consumer reads
+   */
+  uint64_t sequence() const noexcept { return _read_index; }
+
+  /**
+   * Checks whether the next message is published with a single load of its slot version, without
+   * copying it. A slot that is being written is reported as not empty, and so is a slot reset by a
+   * trim the consumer was behind on when the trim retained messages ahead of it.
+   * @return true when a read would return Empty
+   */
+  bool empty() const noexcept
+  {
+    // Acquire, so that a slot reset by a trim is only seen together with the indices of that trim
+    uint64_t const version = _slots[_read_index & _mask].version.load(std::memory_order_acquire);
+
+    if (version >= detail::published_version(_read_index))
+    {
+      return false;
+    }
+
+    // Only a trimmed or never written slot can leave the consumer behind retained messages, or
+    // behind messages written after a trim that retained none
+    if (version != 0)
+    {
+      return true;
+    }
+
+    uint64_t const oldest = retained_after_trim();
+    return (oldest == 0) ||
+      (_slots[oldest & _mask].version.load(std::memory_order_relaxed) < detail::published_version(oldest));
+  }
+
+  /**
+   * Non blocking read.
+   * @param result
+   * @return true if successfully read, false otherwise
+   */
+  bool try_read(value_t& result) noexcept { return read_slot(result) == ReadResult::Success; }
+
+  /**
+   * Non blocking read that, when the producer is in the middle of writing the slot of the next
+   * message, spins with pause up to max_retries times instead of returning. Saves a trip through
+   * the caller's poll loop under heavy write rates.
+   * @param result
+   * @param max_retries
+   * @return Success, Empty when there is no new message, or Busy when the slot was still being
+   * written after max_retries
+   */
+  ReadResult try_read_retry(value_t& result, uint32_t max_retries) noexcept
+  {
+    ReadResult read_result = read_slot(result);
+
+    for (uint32_t retry = 0; (read_result == ReadResult::Busy) && (retry < max_retries); ++retry)
+    {
+      detail::cpu_pause();
+      read_result = read_slot(result);
+    }
+
+    return read_result;
+  }
+
+  /**
+   * Non blocking read of up to max_count messages. After the first message, the run of published
+   * messages that follows is found by loading the version of each following slot until one is not
+   * published yet and is then copied in one go, which makes draining a backlog much cheaper than
+   * calling try_read for each message. Groups published with write_group can be split between calls, use
+   * try_read_group to receive them whole.
+   * @param results array of at least max_count values
+   * @param max_count
+   * @return the number of messages read
+   */
+  size_t try_read_batch(value_t* results, size_t max_count) noexcept
+  {
+    // The first read also takes care of a producer that lapped the consumer
+    if ((max_count == 0) || !try_read(results[0]))
+    {
+      return 0;
+    }
+
+    size_t count{1};
+
+    while (count < max_count)
+    {
+      size_t const run = detail::published_run(_slots, _mask, _read_index, max_count - count);
+
+      if (run == 0)
+      {
+        break;
+      }
+
+      std::atomic_signal_fence(std::memory_order_acq_rel);
+
+      for (size_t i = 0; i < run; ++i)
+      {
+        detail::copy_value(results[count + i], _slots[(_read_index + i) & _mask].value, _simd_level);
+      }
+
+      std::atomic_signal_fence(std::memory_order_acq_rel);
+
+      // Only the messages that were not overwritten while we were copying them are valid
+      size_t const valid = detail::published_run(_slots, _mask, _read_index, run);
+
+      _read_index += valid;
+      count += valid;
+      read_succeeded(valid);
+
+      if (valid != run)
+      {
+        read_torn();
+        break;
+      }
+    }
+
+    prefetch_next();
+
+    return count;
+  }
+
+  /**
+   * Non blocking read of the next group of messages published with write_group, or of the next
+   * single message. The group is only returned when all of its messages were read; a group that
+   * was partly overwritten by the producer, or that has more than max_count messages, is skipped.
+   * @param results array of at least max_count values
+   * @param max_count
+   * @return the number of messages in the group, 0 when there is no complete group to read
+   */
+  size_t try_read_group(value_t* results, size_t max_count) noexcept
+  {
+    if (max_count == 0)
+    {
+      return 0;
+    }
+
+    size_t count{0};
+    uint64_t sequence = _read_index;
+    uint64_t version{0};
+
+    while (read_slot(results[count], version) == ReadResult::Success)
+    {
+      bool const lapped = detail::next_sequence(version) != sequence + 1;
+      sequence = _read_index;
+
+      if (version & detail::VERSION_GROUP_CONTINUATION)
+      {
+        if ((count == 0) || lapped)
+        {
+          // The start of this group was overwritten, or skipped, skip the rest of it
+          count = 0;
+          continue;
+        }
+      }
+      else if (count != 0)
+      {
+        // The producer lapped us in the middle of a group, a new one starts with this message
+        results[0] = results[count];
+        count = 0;
+      }
+
+      ++count;
+
+      if (!(version & detail::VERSION_GROUP_CONTINUES))
+      {
+        return count;
+      }
+
+      if (count == max_count)
+      {
+        // The group does not fit in results
+        count = 0;
+      }
+    }
+
+    // The rest of a group is published before its first message, so a group can only be cut short
+    // when the producer is overwriting it
+    return 0;
+  }
+
+  /**
+   * Non blocking read of the next message whose tag is accepted by the predicate. The tag is
+   * checked before the value is read, the messages that are not accepted are skipped without
+   * copying them. Requires a Tagged queue.
+   * @param result
+   * @param predicate called with the tag of each message, e.g. TagMask{mask}
+   * @return true if a message was read, false when there is no new accepted message
+   */
+  template <typename TPredicate>
+  bool try_read_if(value_t& result, TPredicate predicate) noexcept
+  {
+    bool accepted{false};
+
+    while (read_slot_if(result, predicate, accepted) == ReadResult::Success)
+    {
+      if (accepted)
+      {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * Filtered drain, reads up to max_count messages whose tag is accepted by the predicate and
+   * skips the rest. Requires a Tagged queue.
+   * @param results array of at least max_count values
+   * @param max_count
+   * @param predicate called with the tag of each message, e.g. TagMask{mask}
+   * @return the number of messages read
+   */
+  template <typename TPredicate>
+  size_t try_read_batch_if(value_t* results, size_t max_count, TPredicate predicate) noexcept
+  {
+    size_t count{0};
+    bool accepted{false};
+
+    while ((count < max_count) && (read_slot_if(results[count], predicate, accepted) == ReadResult::Success))
+    {
+      count += accepted ? 1 : 0;
+    }
+
+    return count;
+  }
+
+#if defined(SEQLOCK_QUEUE_INSTRUMENTATION)
+  ConsumerStats const& stats() const noexcept { return _stats; }
+#endif
+
+  template <typename>
+  friend class SeqlockQueuePollSet;
+
+  template <typename>
+  friend class MultiMessageSeqlockQueueConsumer;
+
+private:
+  ReadResult read_slot(value_t& result) noexcept
+  {
+    uint64_t version;
+    return read_slot(result, version);
+  }
+
+  /**
+   * @param version the version of the message when it was read successfully
+   */
+  ReadResult read_slot(value_t& result, uint64_t& version) noexcept
+  {
+    slot_t const& slot = _slots[_read_index & _mask];
+
+    if constexpr (detail::is_packed_slot_v<slot_t>)
+    {
+      if (_atomic_16b)
+      {
+        // The value and the version are read together with a single load, the read can not tear
+        version = detail::load_packed(&slot, result);
+        std::atomic_signal_fence(std::memory_order_acq_rel);
+
+        if (version & detail::VERSION_WRITING) [[unlikely]]
+        {
+          read_torn();
+          return ReadResult::Busy;
+        }
+
+        if ((detail::next_sequence(version) != _read_index + 1) && skip_trimmed()) [[unlikely]]
+        {
+          return read_slot(result, version);
+        }
+
+        if (version < detail::published_version(_read_index))
+        {
+          return ReadResult::Empty;
+        }
+
+        _read_index = detail::next_sequence(version);
+        prefetch_next();
+        read_succeeded(1);
+        return ReadResult::Success;
+      }
+    }
+
+    uint64_t const version_1 = slot.version.load(std::memory_order_acquire);
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+
+    detail::copy_value(result, slot.value, _simd_level);
+
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+    uint64_t const version_2 = slot.version.load(std::memory_order_acquire);
+
+    if ((version_1 != version_2) || (version_1 & detail::VERSION_WRITING)) [[unlikely]]
+    {
+      // This can only happen when the producer catches up with the consumer and tries to
+      // overwrite the slot
+      read_torn();
+      return ReadResult::Busy;
+    }
+
+    if ((detail::next_sequence(version_1) != _read_index + 1) && skip_trimmed()) [[unlikely]]
+    {
+      return read_slot(result, version);
+    }
+
+    if (version_1 < detail::published_version(_read_index))
+    {
+      // The slot still holds a message from the previous lap, was trimmed or was never written
+      return ReadResult::Empty;
+    }
+
+    // Continue after the message we just read. When the version is newer than expected the producer
+    // has overwritten the messages we did not read yet and those are skipped
+    version = version_1;
+    _read_index = detail::next_sequence(version_1);
+    prefetch_next();
+    read_succeeded(1);
+
+    return ReadResult::Success;
+  }
+
+  /**
+   * Like read_slot, but only copies the value when the predicate accepts the tag of the message.
+   * A message that is not accepted is still consumed.
+   */
+  template <typename TPredicate>
+  ReadResult read_slot_if(value_t& result, TPredicate& predicate, bool& accepted) noexcept
+  {
+    static_assert(slot_t::tagged, "filtered reads require a Tagged queue");
+
+    // Skipped messages only touch the line of the version and the tag. The hardware prefetchers do
+    // not follow such a sparse access pattern
+    detail::prefetch_line(&_slots[(_read_index + TAG_PREFETCH_DISTANCE) & _mask].version);
+
+    slot_t const& slot = _slots[_read_index & _mask];
+
+    uint64_t const version_1 = slot.version.load(std::memory_order_acquire);
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+
+    accepted = predicate(slot.tag.load(std::memory_order_relaxed));
+
+    if (accepted)
+    {
+      detail::copy_value(result, slot.value, _simd_level);
+    }
+
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+    uint64_t const version_2 = slot.version.load(std::memory_order_acquire);
+
+    if ((version_1 != version_2) || (version_1 & detail::VERSION_WRITING)) [[unlikely]]
+    {
+      read_torn();
+      return ReadResult::Busy;
+    }
+
+    if ((detail::next_sequence(version_1) != _read_index + 1) && skip_trimmed()) [[unlikely]]
+    {
+      return read_slot_if(result, predicate, accepted);
+    }
+
+    if (version_1 < detail::published_version(_read_index))
+    {
+      return ReadResult::Empty;
+    }
+
+    _read_index = detail::next_sequence(version_1);
+    prefetch_next();
+    read_succeeded(accepted ? 1 : 0);
+
+    return ReadResult::Success;
+  }
+
+  /**
+   * Compares the sequence that was asked for with the message in the slot while it was copied
+   */
+  ReadResult get_result(uint64_t sequence, uint64_t version_1, uint64_t version_2) const noexcept
+  {
+    // The sequence that follows the message now in the slot, 0 when the slot is empty
+    uint64_t const next = detail::next_sequence(version_2);
+
+    if (next == 0)
+    {
+      return sequence < _trim_write_index->load(std::memory_order_acquire) ? ReadResult::Overwritten
+                                                                            : ReadResult::Empty;
+    }
+
+    if (next > sequence + 1)
+    {
+      return ReadResult::Overwritten;
+    }
+
+    if (next < sequence + 1)
+    {
+      return ReadResult::Empty;
+    }
+
+    if ((version_1 != version_2) || (version_2 & detail::VERSION_WRITING)) [[unlikely]]
+    {
+      return ReadResult::Busy;
+    }
+
+    return ReadResult::Success;
+  }
+
+  void move_to(uint64_t sequence) noexcept
+  {
+    _read_index = sequence;
+
+    if (_gating_cursor)
+    {
+      detail::move_gating_cursor(*_gating_cursor, *_gating_limit, _capacity, _read_index);
+    }
+
+    save_position();
+  }
+
+  /**
+   * Moves a consumer that was behind the producer when it trimmed to the oldest message the trim
+   * retained, instead of waiting for the producer to lap its trimmed slot or skipping to the
+   * message that lapped it. Only called when the slot does not hold the next message.
+   * @return true when the consumer was moved
+   */
+  bool skip_trimmed() noexcept
+  {
+    uint64_t const oldest = retained_after_trim();
+
+    if (oldest == 0)
+    {
+      return false;
+    }
+
+    move_to(oldest);
+    return true;
+  }
+
+  /**
+   * The producer publishes the oldest message it retained with each trim, so this is a single load
+   * on every empty read rather than a search of the ring.
+   * @return the oldest message retained by the last trim, or the first one written after it when
+   * the trim retained none, when that message is ahead of the consumer, 0 otherwise
+   */
+  uint64_t retained_after_trim() const noexcept
+  {
+    uint64_t const oldest = _trim_oldest->load(std::memory_order_acquire);
+    return oldest > _read_index ? oldest : 0;
+  }
+
+  uint64_t start_sequence(StartPosition start_position) const noexcept
+  {
+    uint64_t const write_index =
+      detail::find_write_index(_slots, _capacity, *_trim_write_index);
+    uint64_t const oldest = detail::find_oldest_sequence(_slots, _capacity, write_index);
+
+    return write_index - oldest > start_position.backlog ? write_index - start_position.backlog : oldest;
+  }
+
+  void read_succeeded([[maybe_unused]] size_t count) noexcept
+  {
+    if (_gating_cursor)
+    {
+      _gating_cursor->sequence.store(_read_index, std::memory_order_release);
+    }
+
+    if (_read_index >= _next_save) [[unlikely]]
+    {
+      save_position();
+    }
+
+#if defined(SEQLOCK_QUEUE_INSTRUMENTATION)
+    _stats.reads += count;
+#endif
+  }
+
+  void save_position() noexcept
+  {
+    if (_saved_sequence)
+    {
+      _saved_sequence->store(_read_index, std::memory_order_release);
+      _next_save = _read_index + _save_interval;
+    }
+  }
+
+  void read_torn() noexcept
+  {
+#if defined(SEQLOCK_QUEUE_INSTRUMENTATION)
+    ++_stats.torn_reads;
+#endif
+  }
+
+  void prefetch_next() const noexcept
+  {
+    if constexpr (PrefetchNext)
+    {
+      detail::prefetch_slot<false>(_slots + (_read_index & _mask));
+    }
+  }
+
+private:
+  static constexpr size_t TAG_PREFETCH_DISTANCE{16};
+
   slot_t const* _slots{nullptr};
   size_t _capacity{0};
   size_t _mask{0};
   size_t _read_index{0};
-  uint8_t _read_version{0};
+  detail::GatingCursor* _gating_cursor{nullptr};
+  std::atomic<uint64_t> const* _trim_write_index{nullptr};
+  std::atomic<uint64_t> const* _trim_oldest{nullptr};
+  detail::GatingLimit const* _gating_limit{nullptr};
+  std::atomic<uint64_t>* _saved_sequence{nullptr};
+  uint64_t _save_interval{0};
+  uint64_t _next_save{std::numeric_limits<uint64_t>::max()};
+  bool _atomic_16b{false};
+  detail::SimdLevel _simd_level{detail::SimdLevel::Scalar};
+
+#if defined(SEQLOCK_QUEUE_INSTRUMENTATION)
+  ConsumerStats _stats;
+#endif
 };
 } // namespace sq
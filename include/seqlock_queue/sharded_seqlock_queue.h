@@ -0,0 +1,233 @@
+#pragma once
+
+#include "seqlock_queue/seqlock_queue.h"
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace sq
+{
+/**
+ * Several BoundedSeqlockQueue rings, the shards, with messages routed to a shard by a key hash.
+ * Messages with the same key go to the same shard and keep their order. Each shard has its own
+ * producer, so writers and readers of different shards scale across cores independently.
+ */
+template <typename T, size_t SlotAlignment = detail::CACHE_ALIGNED, size_t CacheAligned = detail::CACHE_ALIGNED>
+class ShardedSeqlockQueue
+{
+public:
+  using value_t = T;
+  using queue_t = BoundedSeqlockQueue<T, SlotAlignment, CacheAligned>;
+
+  ShardedSeqlockQueue(ShardedSeqlockQueue const&) = delete;
+  ShardedSeqlockQueue& operator=(ShardedSeqlockQueue const&) = delete;
+  ShardedSeqlockQueue(ShardedSeqlockQueue&&) = delete;
+  ShardedSeqlockQueue& operator=(ShardedSeqlockQueue&&) = delete;
+
+  /**
+   * @param shard_count
+   * @param capacity the capacity of each shard
+   * @param huge_pages
+   * @param max_lossless_consumers per shard
+   */
+  ShardedSeqlockQueue(size_t shard_count, size_t capacity, bool huge_pages = false, size_t max_lossless_consumers = 0)
+  {
+    if (shard_count == 0)
+    {
+      throw std::runtime_error{"a sharded queue needs at least one shard"};
+    }
+
+    _shards.reserve(shard_count);
+
+    for (size_t i = 0; i < shard_count; ++i)
+    {
+      _shards.push_back(std::make_unique<queue_t>(capacity, huge_pages, max_lossless_consumers));
+    }
+  }
+
+  /***/
+  size_t shard_count() const noexcept { return _shards.size(); }
+
+  /**
+   * @return the shard the messages with the given key hash are written to
+   */
+  size_t shard_of(uint64_t key_hash) const noexcept { return key_hash % _shards.size(); }
+
+  /***/
+  queue_t& shard(size_t index) noexcept { return *_shards[index]; }
+
+  /***/
+  queue_t const& shard(size_t index) const noexcept { return *_shards[index]; }
+
+private:
+  std::vector<std::unique_ptr<queue_t>> _shards;
+};
+
+/**
+ * Writes to the shards of a ShardedSeqlockQueue. Every shard must be written by a single
+ * producer, so each producer thread owns a disjoint set of shards and writes only the keys that
+ * map to them.
+ */
+template <typename TShardedSeqlockQueue>
+class ShardedSeqlockQueueProducer
+{
+public:
+  using value_t = typename TShardedSeqlockQueue::value_t;
+  using queue_t = typename TShardedSeqlockQueue::queue_t;
+  using producer_t = SeqlockQueueProducer<queue_t>;
+
+  ShardedSeqlockQueueProducer(ShardedSeqlockQueueProducer const&) = delete;
+  ShardedSeqlockQueueProducer& operator=(ShardedSeqlockQueueProducer const&) = delete;
+  ShardedSeqlockQueueProducer(ShardedSeqlockQueueProducer&&) = delete;
+  ShardedSeqlockQueueProducer& operator=(ShardedSeqlockQueueProducer&&) = delete;
+
+  /**
+   * Owns all the shards
+   */
+  explicit ShardedSeqlockQueueProducer(TShardedSeqlockQueue const& sharded_queue,
+                                       WaitStrategy wait_strategy = WaitStrategy::Spin)
+    : ShardedSeqlockQueueProducer(sharded_queue, all_shards(sharded_queue), wait_strategy)
+  {
+  }
+
+  /**
+   * @param sharded_queue
+   * @param shards the indices of the shards this producer owns
+   * @param wait_strategy
+   */
+  ShardedSeqlockQueueProducer(TShardedSeqlockQueue const& sharded_queue, std::vector<size_t> const& shards,
+                              WaitStrategy wait_strategy = WaitStrategy::Spin)
+    : _sharded_queue(&sharded_queue), _producers(sharded_queue.shard_count())
+  {
+    for (size_t shard : shards)
+    {
+      if (shard >= sharded_queue.shard_count())
+      {
+        throw std::runtime_error{"invalid shard index " + std::to_string(shard)};
+      }
+
+      _producers[shard] = std::make_unique<producer_t>(sharded_queue.shard(shard), wait_strategy);
+    }
+  }
+
+  /**
+   * @param key_hash the hash of the key of the message, must map to a shard this producer owns
+   * @param value
+   */
+  void write(uint64_t key_hash, value_t const& value) noexcept { producer(key_hash).write(value); }
+
+  /**
+   * @param key_hash the hash of the key of the message, must map to a shard this producer owns
+   * @param callback fills the value in place
+   */
+  template <typename TCallback>
+  void write(uint64_t key_hash, TCallback callback) noexcept
+  {
+    producer(key_hash).write(callback);
+  }
+
+private:
+  static std::vector<size_t> all_shards(TShardedSeqlockQueue const& sharded_queue)
+  {
+    std::vector<size_t> shards(sharded_queue.shard_count());
+    std::iota(shards.begin(), shards.end(), size_t{0});
+    return shards;
+  }
+
+  producer_t& producer(uint64_t key_hash) noexcept
+  {
+    auto& producer = _producers[_sharded_queue->shard_of(key_hash)];
+    assert(producer && "the key maps to a shard this producer does not own");
+    return *producer;
+  }
+
+private:
+  TShardedSeqlockQueue const* _sharded_queue{nullptr};
+  std::vector<std::unique_ptr<producer_t>> _producers;
+};
+
+/**
+ * Reads the shards of a ShardedSeqlockQueue it subscribed to, in turns
+ */
+template <typename TShardedSeqlockQueue>
+class ShardedSeqlockQueueConsumer
+{
+public:
+  using value_t = typename TShardedSeqlockQueue::value_t;
+  using queue_t = typename TShardedSeqlockQueue::queue_t;
+  using consumer_t = SeqlockQueueConsumer<queue_t>;
+
+  ShardedSeqlockQueueConsumer(ShardedSeqlockQueueConsumer const&) = delete;
+  ShardedSeqlockQueueConsumer& operator=(ShardedSeqlockQueueConsumer const&) = delete;
+  ShardedSeqlockQueueConsumer(ShardedSeqlockQueueConsumer&&) = delete;
+  ShardedSeqlockQueueConsumer& operator=(ShardedSeqlockQueueConsumer&&) = delete;
+
+  /**
+   * @param sharded_queue
+   * @param shards the indices of the shards to read, e.g. sharded_queue.shard_of(key_hash) for the
+   * keys of interest
+   * @param mode
+   * @param start_position
+   */
+  ShardedSeqlockQueueConsumer(TShardedSeqlockQueue& sharded_queue, std::vector<size_t> const& shards,
+                              ConsumerMode mode = ConsumerMode::Lossy,
+                              StartPosition start_position = StartPosition::oldest())
+  {
+    _consumers.reserve(shards.size());
+    _shards.reserve(shards.size());
+
+    for (size_t shard : shards)
+    {
+      if (shard >= sharded_queue.shard_count())
+      {
+        throw std::runtime_error{"invalid shard index " + std::to_string(shard)};
+      }
+
+      _consumers.push_back(std::make_unique<consumer_t>(sharded_queue.shard(shard), mode, start_position));
+      _shards.push_back(shard);
+    }
+  }
+
+  /**
+   * Non blocking read of the next message of one of the shards. The shards are visited in turns,
+   * starting with the first one and then after the one that was read last, so a busy shard does not
+   * starve the others.
+   * @param result
+   * @return true if successfully read, false otherwise
+   */
+  bool try_read(value_t& result) noexcept
+  {
+    size_t const count = _consumers.size();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      size_t const index = _next;
+      _next = (_next + 1 == count) ? 0 : _next + 1;
+
+      if (_consumers[index]->try_read(result))
+      {
+        _last_shard = _shards[index];
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * @return the shard of the last message read
+   */
+  size_t last_shard() const noexcept { return _last_shard; }
+
+private:
+  std::vector<std::unique_ptr<consumer_t>> _consumers;
+  std::vector<size_t> _shards;
+  // The consumer visited first by the next read
+  size_t _next{0};
+  size_t _last_shard{0};
+};
+} // namespace sq
@@ -0,0 +1,201 @@
+#include "doctest/doctest.h"
+
+#include "seqlock_queue/consumer_group.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_SUITE_BEGIN("ConsumerGroup");
+
+using namespace sq;
+
+struct Test1
+{
+  uint64_t x;
+  uint64_t y;
+  uint32_t z;
+};
+
+/***/
+TEST_CASE("consumer_group_splits_messages")
+{
+  constexpr size_t capacity{64};
+
+  using seqlock_queue_t = BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+
+  ConsumerGroup group{seqlock_queue};
+  SeqlockQueueGroupConsumer<seqlock_queue_t> member_1{seqlock_queue, group};
+  SeqlockQueueGroupConsumer<seqlock_queue_t> member_2{seqlock_queue, group};
+
+  Test1 result;
+  REQUIRE_EQ(member_1.try_read(result), ReadResult::Empty);
+
+  for (uint32_t i = 0; i < 30; ++i)
+  {
+    producer.write(Test1{i, i, i});
+  }
+
+  // the members take turns, each message is read once
+  for (uint32_t i = 0; i < 30; ++i)
+  {
+    auto& member = (i % 3 == 0) ? member_1 : member_2;
+    REQUIRE_EQ(member.try_read(result), ReadResult::Success);
+    REQUIRE_EQ(result.x, i);
+  }
+
+  REQUIRE_EQ(member_1.try_read(result), ReadResult::Empty);
+  REQUIRE_EQ(member_2.try_read(result), ReadResult::Empty);
+  REQUIRE_EQ(group.overwritten_claims(), 0);
+  REQUIRE_EQ(group.lost_messages(), 0);
+}
+
+/***/
+TEST_CASE("consumer_group_overwritten_claims")
+{
+  constexpr size_t capacity{16};
+
+  using seqlock_queue_t = BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+
+  // Claims from the first message, which the producer overwrites before it is read
+  ConsumerGroup group{0};
+  SeqlockQueueGroupConsumer<seqlock_queue_t> member{seqlock_queue, group};
+
+  for (uint32_t i = 0; i < 40; ++i)
+  {
+    producer.write(Test1{i, i, i});
+  }
+
+  // message 0 is claimed but gone, the group continues from the oldest message and loses 1 to 23
+  Test1 result;
+  REQUIRE_EQ(member.try_read(result), ReadResult::Overwritten);
+  REQUIRE_EQ(group.overwritten_claims(), 1);
+  REQUIRE_EQ(group.lost_messages(), 24);
+
+  for (uint32_t i = 24; i < 40; ++i)
+  {
+    REQUIRE_EQ(member.try_read(result), ReadResult::Success);
+    REQUIRE_EQ(result.x, i);
+  }
+
+  REQUIRE_EQ(member.try_read(result), ReadResult::Empty);
+  REQUIRE_EQ(group.lost_messages(), 24);
+}
+
+/***/
+TEST_CASE("consumer_group_attached_after_wrap")
+{
+  constexpr size_t capacity{16};
+
+  using seqlock_queue_t = BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+
+  for (uint32_t i = 0; i < 40; ++i)
+  {
+    producer.write(Test1{i, i, i});
+  }
+
+  Test1 result;
+
+  {
+    // By default the group reads the messages written after it was created
+    ConsumerGroup group{seqlock_queue};
+    SeqlockQueueGroupConsumer<seqlock_queue_t> member{seqlock_queue, group};
+    REQUIRE_EQ(member.try_read(result), ReadResult::Empty);
+
+    producer.write(Test1{40, 40, 40});
+    REQUIRE_EQ(member.try_read(result), ReadResult::Success);
+    REQUIRE_EQ(result.x, 40);
+    REQUIRE_EQ(group.overwritten_claims(), 0);
+  }
+
+  // From the oldest retained message, without claiming the overwritten ones
+  ConsumerGroup group{seqlock_queue, StartPosition::oldest()};
+  SeqlockQueueGroupConsumer<seqlock_queue_t> member{seqlock_queue, group};
+
+  for (uint32_t i = 25; i < 41; ++i)
+  {
+    REQUIRE_EQ(member.try_read(result), ReadResult::Success);
+    REQUIRE_EQ(result.x, i);
+  }
+
+  REQUIRE_EQ(member.try_read(result), ReadResult::Empty);
+  REQUIRE_EQ(group.overwritten_claims(), 0);
+}
+
+/***/
+TEST_CASE("consumer_group_multi_thread")
+{
+  constexpr size_t capacity{1024};
+  constexpr uint32_t messages{100'000};
+  constexpr size_t members{4};
+
+  using seqlock_queue_t = BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  ConsumerGroup group{seqlock_queue};
+
+  std::vector<std::atomic<uint32_t>> reads(messages);
+  std::atomic<bool> done{false};
+  std::atomic<uint64_t> total_reads{0};
+
+  std::vector<std::thread> threads;
+  for (size_t m = 0; m < members; ++m)
+  {
+    threads.emplace_back(
+      [&]()
+      {
+        SeqlockQueueGroupConsumer<seqlock_queue_t> member{seqlock_queue, group};
+        Test1 result;
+
+        while (true)
+        {
+          // Loaded before the read, so that the member only stops once all messages are written
+          bool const finished = done.load();
+          ReadResult const read_result = member.try_read(result);
+
+          if (read_result == ReadResult::Success)
+          {
+            REQUIRE_EQ(result.x, result.y);
+            reads[result.x].fetch_add(1);
+            total_reads.fetch_add(1);
+          }
+          else if ((read_result == ReadResult::Empty) && finished)
+          {
+            break;
+          }
+        }
+      });
+  }
+
+  for (uint32_t i = 0; i < messages; ++i)
+  {
+    producer.write(Test1{i, i, i});
+  }
+
+  done.store(true);
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  // no message is read twice, the ones that were not read were overwritten and counted as lost
+  for (auto const& count : reads)
+  {
+    REQUIRE_LE(count.load(), 1);
+  }
+
+  REQUIRE_EQ(total_reads.load() + group.lost_messages(), messages);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,256 @@
+#include "doctest/doctest.h"
+
+#include "seqlock_queue/coroutine_consumer.h"
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <vector>
+
+TEST_SUITE_BEGIN("CoroutineConsumer");
+
+using namespace sq;
+
+using seqlock_queue_t = BoundedSeqlockQueue<uint64_t>;
+
+namespace
+{
+/**
+ * A coroutine that starts right away and is destroyed by its owner
+ */
+struct Task
+{
+  struct promise_type
+  {
+    Task get_return_object() { return Task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+  Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+  Task(Task const&) = delete;
+
+  ~Task()
+  {
+    if (handle)
+    {
+      handle.destroy();
+    }
+  }
+
+  bool done() const { return handle.done(); }
+
+  std::coroutine_handle<promise_type> handle;
+};
+
+Task subscribe(SeqlockQueueAwaitableConsumer<seqlock_queue_t>& consumer, size_t count,
+               std::vector<uint64_t>& received)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    received.push_back(co_await consumer.next());
+  }
+}
+
+Task destroy_after_next(SeqlockQueueAwaitableConsumer<seqlock_queue_t>& consumer,
+                        std::unique_ptr<SeqlockQueueAwaitableConsumer<seqlock_queue_t>>& other)
+{
+  co_await consumer.next();
+  other.reset();
+}
+
+Task poll_after_next(SeqlockQueueAwaitableConsumer<seqlock_queue_t>& consumer, SeqlockQueuePoller& poller,
+                     SeqlockQueueProducer<seqlock_queue_t>& producer, size_t& resumed)
+{
+  co_await consumer.next();
+  producer.write(uint64_t{30});
+  resumed = poller.poll();
+}
+} // namespace
+
+/***/
+TEST_CASE("awaitable_consumer")
+{
+  seqlock_queue_t seqlock_queue{16};
+  SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+
+  SeqlockQueuePoller poller;
+  SeqlockQueueAwaitableConsumer<seqlock_queue_t> consumer{seqlock_queue, poller};
+
+  // The first message is already there, the coroutine does not suspend for it
+  producer.write(uint64_t{10});
+
+  std::vector<uint64_t> received;
+  Task task = subscribe(consumer, 3, received);
+
+  REQUIRE_EQ(received, std::vector<uint64_t>{10});
+  REQUIRE_EQ(poller.waiting(), 1);
+
+  REQUIRE_EQ(poller.poll(), 0);
+
+  producer.write(uint64_t{11});
+  producer.write(uint64_t{12});
+
+  // Resumed once, then the second message is read without suspending
+  REQUIRE_EQ(poller.poll(), 1);
+  REQUIRE_EQ(received, std::vector<uint64_t>{10, 11, 12});
+  REQUIRE(task.done());
+  REQUIRE_EQ(poller.waiting(), 0);
+}
+
+/***/
+TEST_CASE("awaitable_consumer_many_subscriptions")
+{
+  constexpr size_t subscriptions{200};
+
+  std::vector<std::unique_ptr<seqlock_queue_t>> queues;
+  std::vector<std::unique_ptr<SeqlockQueueProducer<seqlock_queue_t>>> producers;
+  std::vector<std::unique_ptr<SeqlockQueueAwaitableConsumer<seqlock_queue_t>>> consumers;
+  std::vector<std::vector<uint64_t>> received(subscriptions);
+  std::vector<Task> tasks;
+
+  SeqlockQueuePoller poller;
+
+  for (size_t i = 0; i < subscriptions; ++i)
+  {
+    queues.push_back(std::make_unique<seqlock_queue_t>(16));
+    producers.push_back(std::make_unique<SeqlockQueueProducer<seqlock_queue_t>>(*queues.back()));
+    consumers.push_back(
+      std::make_unique<SeqlockQueueAwaitableConsumer<seqlock_queue_t>>(*queues.back(), poller));
+    tasks.push_back(subscribe(*consumers.back(), 2, received[i]));
+  }
+
+  REQUIRE_EQ(poller.waiting(), subscriptions);
+
+  // One pass of the poller resumes every subscription with a message
+  for (size_t i = 0; i < subscriptions; i += 3)
+  {
+    producers[i]->write(uint64_t{i});
+  }
+
+  REQUIRE_EQ(poller.poll(), (subscriptions + 2) / 3);
+  REQUIRE_EQ(poller.waiting(), subscriptions);
+
+  for (size_t i = 0; i < subscriptions; ++i)
+  {
+    REQUIRE_EQ(received[i].size(), (i % 3 == 0) ? 1 : 0);
+    producers[i]->write(uint64_t{i + 1000});
+  }
+
+  REQUIRE_EQ(poller.poll(), subscriptions);
+
+  // The subscriptions that had their first message earlier are done, the others wait again
+  size_t const done = (subscriptions + 2) / 3;
+  REQUIRE_EQ(poller.waiting(), subscriptions - done);
+
+  for (size_t i = 0; i < subscriptions; ++i)
+  {
+    if (!tasks[i].done())
+    {
+      producers[i]->write(uint64_t{i + 2000});
+    }
+  }
+
+  REQUIRE_EQ(poller.poll(), subscriptions - done);
+
+  for (size_t i = 0; i < subscriptions; ++i)
+  {
+    REQUIRE(tasks[i].done());
+    REQUIRE_EQ(received[i].back(), (i % 3 == 0) ? i + 1000 : i + 2000);
+  }
+
+  REQUIRE_EQ(poller.waiting(), 0);
+}
+
+/***/
+TEST_CASE("awaitable_consumer_destroyed")
+{
+  seqlock_queue_t seqlock_queue{16};
+  SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  SeqlockQueuePoller poller;
+
+  std::vector<uint64_t> received;
+
+  {
+    auto consumer = std::make_unique<SeqlockQueueAwaitableConsumer<seqlock_queue_t>>(seqlock_queue, poller);
+    Task task = subscribe(*consumer, 1, received);
+    REQUIRE_EQ(poller.waiting(), 1);
+
+    consumer.reset();
+    REQUIRE_EQ(poller.waiting(), 0);
+  }
+
+  producer.write(uint64_t{1});
+  REQUIRE_EQ(poller.poll(), 0);
+  REQUIRE(received.empty());
+}
+
+/***/
+TEST_CASE("awaitable_consumer_destroyed_while_resuming")
+{
+  seqlock_queue_t queue_1{16};
+  seqlock_queue_t queue_2{16};
+  SeqlockQueueProducer<seqlock_queue_t> producer_1{queue_1};
+  SeqlockQueueProducer<seqlock_queue_t> producer_2{queue_2};
+  SeqlockQueuePoller poller;
+
+  SeqlockQueueAwaitableConsumer<seqlock_queue_t> consumer_1{queue_1, poller};
+  auto consumer_2 = std::make_unique<SeqlockQueueAwaitableConsumer<seqlock_queue_t>>(queue_2, poller);
+
+  std::vector<uint64_t> received;
+  Task destroying = destroy_after_next(consumer_1, consumer_2);
+  Task destroyed = subscribe(*consumer_2, 1, received);
+
+  // Both read their message in the same pass, the first one resumed destroys the consumer of the
+  // second, which is then not resumed
+  producer_1.write(uint64_t{1});
+  producer_2.write(uint64_t{2});
+
+  REQUIRE_EQ(poller.poll(), 1);
+  REQUIRE(destroying.done());
+  REQUIRE_FALSE(destroyed.done());
+  REQUIRE(received.empty());
+  REQUIRE_EQ(poller.waiting(), 0);
+}
+
+/***/
+TEST_CASE("awaitable_consumer_nested_poll")
+{
+  seqlock_queue_t queue_1{16};
+  seqlock_queue_t queue_2{16};
+  seqlock_queue_t queue_3{16};
+  SeqlockQueueProducer<seqlock_queue_t> producer_1{queue_1};
+  SeqlockQueueProducer<seqlock_queue_t> producer_2{queue_2};
+  SeqlockQueueProducer<seqlock_queue_t> producer_3{queue_3};
+  SeqlockQueuePoller poller;
+
+  SeqlockQueueAwaitableConsumer<seqlock_queue_t> consumer_1{queue_1, poller};
+  SeqlockQueueAwaitableConsumer<seqlock_queue_t> consumer_2{queue_2, poller};
+  SeqlockQueueAwaitableConsumer<seqlock_queue_t> consumer_3{queue_3, poller};
+
+  size_t nested_resumed{0};
+  std::vector<uint64_t> received_2;
+  std::vector<uint64_t> received_3;
+
+  Task polling = poll_after_next(consumer_1, poller, producer_3, nested_resumed);
+  Task task_2 = subscribe(consumer_2, 1, received_2);
+  Task task_3 = subscribe(consumer_3, 1, received_3);
+
+  producer_1.write(uint64_t{10});
+  producer_2.write(uint64_t{20});
+
+  // The first coroutine polls again while the outer poll still has the second one to resume
+  REQUIRE_EQ(poller.poll(), 2);
+  REQUIRE_EQ(nested_resumed, 1);
+  REQUIRE_EQ(received_2, std::vector<uint64_t>{20});
+  REQUIRE_EQ(received_3, std::vector<uint64_t>{30});
+  REQUIRE(polling.done());
+  REQUIRE(task_2.done());
+  REQUIRE(task_3.done());
+  REQUIRE_EQ(poller.waiting(), 0);
+}
+
+TEST_SUITE_END();
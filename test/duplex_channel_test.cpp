@@ -0,0 +1,255 @@
+#include "doctest/doctest.h"
+
+#include "seqlock_queue/duplex_channel.h"
+
+#include <atomic>
+#include <thread>
+
+TEST_SUITE_BEGIN("DuplexChannel");
+
+using namespace sq;
+
+struct NewOrder
+{
+  uint64_t order_id;
+  uint64_t price;
+  uint64_t quantity;
+};
+
+struct OrderAck
+{
+  uint64_t order_id;
+  bool accepted;
+};
+
+using channel_t = DuplexChannel<NewOrder, OrderAck>;
+
+/***/
+TEST_CASE("duplex_channel_send_and_reply")
+{
+  channel_t channel{16};
+  DuplexChannelClient<channel_t> client{channel};
+  DuplexChannelServer<channel_t> server{channel};
+
+  uint64_t correlation_id{};
+  NewOrder order{};
+  OrderAck ack{};
+
+  REQUIRE_FALSE(server.try_receive(correlation_id, order));
+  REQUIRE_FALSE(client.try_receive(correlation_id, ack));
+
+  uint64_t const first = client.send(NewOrder{1, 100, 5});
+  uint64_t const second = client.send(NewOrder{2, 101, 6});
+  REQUIRE_NE(first, second);
+
+  REQUIRE(server.try_receive(correlation_id, order));
+  REQUIRE_EQ(correlation_id, first);
+  REQUIRE_EQ(order.order_id, 1);
+
+  REQUIRE(server.try_receive(correlation_id, order));
+  REQUIRE_EQ(correlation_id, second);
+  REQUIRE_EQ(order.quantity, 6);
+
+  // Responses can be sent in any order, the correlation id matches them with their requests
+  server.reply(second, OrderAck{2, false});
+  server.reply(first, OrderAck{1, true});
+
+  REQUIRE(client.try_receive(correlation_id, ack));
+  REQUIRE_EQ(correlation_id, second);
+  REQUIRE_FALSE(ack.accepted);
+
+  REQUIRE(client.try_receive(correlation_id, ack));
+  REQUIRE_EQ(correlation_id, first);
+  REQUIRE(ack.accepted);
+}
+
+/***/
+TEST_CASE("duplex_channel_try_send_and_try_reply")
+{
+  constexpr size_t capacity{4};
+
+  channel_t channel{capacity};
+  DuplexChannelClient<channel_t> client{channel};
+  DuplexChannelServer<channel_t> server{channel};
+
+  // A client pipelining requests fills the request ring, try_send fails instead of waiting
+  uint64_t correlation_id{};
+  for (uint64_t i = 0; i < capacity; ++i)
+  {
+    REQUIRE(client.try_send(NewOrder{i, 100, 1}, correlation_id));
+    REQUIRE_EQ(correlation_id, i + 1);
+  }
+  REQUIRE_FALSE(client.try_send(NewOrder{capacity, 100, 1}, correlation_id));
+  REQUIRE_EQ(correlation_id, capacity);
+
+  NewOrder order{};
+  for (uint64_t i = 0; i < capacity; ++i)
+  {
+    REQUIRE(server.try_receive(correlation_id, order));
+    REQUIRE(server.try_reply(correlation_id, OrderAck{order.order_id, true}));
+  }
+
+  // The client did not drain the responses, try_reply fails where reply() would block
+  REQUIRE(client.try_send(NewOrder{capacity, 100, 1}, correlation_id));
+  REQUIRE_EQ(correlation_id, capacity + 1);
+  REQUIRE(server.try_receive(correlation_id, order));
+  REQUIRE_FALSE(server.try_reply(correlation_id, OrderAck{order.order_id, true}));
+
+  OrderAck ack{};
+  uint64_t response_id{};
+  REQUIRE(client.try_receive(response_id, ack));
+  REQUIRE_EQ(response_id, 1);
+
+  REQUIRE(server.try_reply(correlation_id, OrderAck{order.order_id, true}));
+
+  for (uint64_t i = 1; i <= capacity; ++i)
+  {
+    REQUIRE(client.try_receive(response_id, ack));
+    REQUIRE_EQ(response_id, i + 1);
+    REQUIRE_EQ(ack.order_id, i);
+  }
+  REQUIRE_FALSE(client.try_receive(response_id, ack));
+}
+
+/***/
+TEST_CASE("duplex_channel_call_drains_stale_responses")
+{
+  constexpr size_t capacity{4};
+
+  channel_t channel{capacity};
+  DuplexChannelClient<channel_t> client{channel, WaitStrategy::Yield};
+  DuplexChannelServer<channel_t> server{channel, WaitStrategy::Yield};
+
+  // The responses to the first requests fill the response ring, the client does not read them
+  uint64_t correlation_id{};
+  NewOrder order{};
+  for (uint64_t i = 0; i < capacity; ++i)
+  {
+    client.send(NewOrder{i, 100, 1});
+    REQUIRE(server.try_receive(correlation_id, order));
+    REQUIRE(server.try_reply(correlation_id, OrderAck{order.order_id, true}));
+  }
+
+  client.send(NewOrder{capacity, 100, 1});
+
+  std::atomic<bool> running{true};
+  std::atomic<uint64_t> received{0};
+  std::thread server_thread{[&server, &running, &received]()
+                            {
+                              uint64_t id{};
+                              NewOrder request{};
+
+                              while (running.load())
+                              {
+                                if (server.try_receive(id, request))
+                                {
+                                  received.fetch_add(1);
+                                  server.reply(id, OrderAck{request.order_id, true});
+                                }
+                                else
+                                {
+                                  std::this_thread::yield();
+                                }
+                              }
+                            }};
+
+  // The server is blocked in reply(), the client fills the request ring
+  while (received.load() == 0)
+  {
+    std::this_thread::yield();
+  }
+
+  uint64_t next{capacity + 1};
+  while (client.try_send(NewOrder{next, 100, 1}, correlation_id))
+  {
+    ++next;
+  }
+
+  // Both rings are full, call() drops the stale responses so the server can make progress
+  OrderAck ack{};
+  REQUIRE(client.call(NewOrder{next, 100, 1}, ack));
+  REQUIRE_EQ(ack.order_id, next);
+
+  running.store(false);
+  server_thread.join();
+}
+
+/***/
+TEST_CASE("duplex_channel_call_timeout")
+{
+  channel_t channel{16};
+  DuplexChannelClient<channel_t> client{channel, WaitStrategy::Yield};
+  DuplexChannelServer<channel_t> server{channel};
+
+  OrderAck ack{};
+  REQUIRE_FALSE(client.call(NewOrder{1, 100, 5}, ack, 1'000'000));
+
+  // The late response to the first call is dropped by the second one
+  uint64_t correlation_id{};
+  NewOrder order{};
+  REQUIRE(server.try_receive(correlation_id, order));
+  server.reply(correlation_id, OrderAck{order.order_id, false});
+
+  std::thread server_thread{[&server]()
+                            {
+                              uint64_t id{};
+                              NewOrder request{};
+
+                              while (!server.try_receive(id, request))
+                              {
+                                std::this_thread::yield();
+                              }
+
+                              server.reply(id, OrderAck{request.order_id, true});
+                            }};
+
+  REQUIRE(client.call(NewOrder{2, 100, 5}, ack));
+  REQUIRE_EQ(ack.order_id, 2);
+  REQUIRE(ack.accepted);
+
+  server_thread.join();
+}
+
+/***/
+TEST_CASE("duplex_channel_call_multi_thread")
+{
+  constexpr uint64_t calls{20'000};
+
+  channel_t channel{8};
+  std::atomic<bool> running{true};
+
+  std::thread server_thread{[&channel, &running]()
+                            {
+                              DuplexChannelServer<channel_t> server{channel, WaitStrategy::Yield};
+
+                              uint64_t correlation_id{};
+                              NewOrder order{};
+
+                              while (running.load(std::memory_order_relaxed))
+                              {
+                                if (server.try_receive(correlation_id, order))
+                                {
+                                  server.reply(correlation_id, OrderAck{order.order_id, (order.price % 2) == 0});
+                                }
+                                else
+                                {
+                                  std::this_thread::yield();
+                                }
+                              }
+                            }};
+
+  DuplexChannelClient<channel_t> client{channel, WaitStrategy::Yield};
+
+  for (uint64_t i = 0; i < calls; ++i)
+  {
+    OrderAck ack{};
+    REQUIRE(client.call(NewOrder{i, i * 3, 1}, ack));
+    REQUIRE_EQ(ack.order_id, i);
+    REQUIRE_EQ(ack.accepted, ((i * 3) % 2) == 0);
+  }
+
+  running.store(false);
+  server_thread.join();
+}
+
+TEST_SUITE_END();
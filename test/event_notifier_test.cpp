@@ -0,0 +1,175 @@
+#include "doctest/doctest.h"
+
+#include "seqlock_queue/event_notifier.h"
+
+#include <chrono>
+#include <poll.h>
+#include <thread>
+
+TEST_SUITE_BEGIN("EventNotifier");
+
+using namespace sq;
+
+using seqlock_queue_t = BoundedSeqlockQueue<uint64_t>;
+
+namespace
+{
+bool readable(int fd, int timeout_ms)
+{
+  pollfd poll_fd{fd, POLLIN, 0};
+  return ::poll(&poll_fd, 1, timeout_ms) == 1;
+}
+} // namespace
+
+/***/
+TEST_CASE("event_notifier_armed")
+{
+  seqlock_queue_t seqlock_queue{16};
+  EventNotifier notifier;
+
+  SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  producer.set_notifier(notifier);
+
+  SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  // Not armed, the producer does not write to the eventfd
+  producer.write(uint64_t{1});
+  REQUIRE_FALSE(readable(notifier.fd(), 0));
+
+  // The consumer has a message to read instead of waiting
+  REQUIRE_FALSE(notifier.arm(consumer));
+
+  uint64_t value;
+  REQUIRE(consumer.try_read(value));
+
+  REQUIRE(notifier.arm(consumer));
+  REQUIRE_FALSE(readable(notifier.fd(), 0));
+
+  producer.write(uint64_t{2});
+  REQUIRE(readable(notifier.fd(), 0));
+
+  // Only the first write after arming wakes the consumer
+  producer.write(uint64_t{3});
+
+  notifier.acknowledge();
+  REQUIRE_FALSE(readable(notifier.fd(), 0));
+
+  REQUIRE(consumer.try_read(value));
+  REQUIRE_EQ(value, 2);
+  REQUIRE(consumer.try_read(value));
+  REQUIRE_EQ(value, 3);
+
+  producer.write(uint64_t{4});
+  REQUIRE_FALSE(readable(notifier.fd(), 0));
+}
+
+/***/
+TEST_CASE("event_notifier_several_queues")
+{
+  seqlock_queue_t first{16};
+  seqlock_queue_t second{16};
+  EventNotifier notifier;
+
+  SeqlockQueueProducer<seqlock_queue_t> first_producer{first};
+  SeqlockQueueProducer<seqlock_queue_t> second_producer{second};
+  first_producer.set_notifier(notifier);
+  second_producer.set_notifier(notifier);
+
+  SeqlockQueueConsumer<seqlock_queue_t> first_consumer{first};
+  SeqlockQueueConsumer<seqlock_queue_t> second_consumer{second};
+
+  second_producer.write(uint64_t{1});
+  REQUIRE_FALSE(notifier.arm(first_consumer, second_consumer));
+
+  uint64_t value;
+  REQUIRE(second_consumer.try_read(value));
+  REQUIRE(notifier.arm(first_consumer, second_consumer));
+
+  second_producer.write(uint64_t{2});
+  REQUIRE(readable(notifier.fd(), 0));
+}
+
+/***/
+TEST_CASE("event_notifier_trimmed_queue")
+{
+  seqlock_queue_t seqlock_queue{16};
+  EventNotifier notifier;
+
+  SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  producer.set_notifier(notifier);
+
+  SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  for (uint64_t i = 0; i < 16; ++i)
+  {
+    producer.write(i);
+  }
+
+  uint64_t value;
+  REQUIRE(consumer.try_read(value));
+  REQUIRE(consumer.try_read(value));
+
+  // The next slot of the consumer was trimmed, the retained messages are read instead of waiting
+  producer.trim(4);
+  REQUIRE_FALSE(notifier.arm(consumer));
+
+  REQUIRE(consumer.try_read(value));
+  REQUIRE_EQ(value, 12);
+
+  for (uint64_t i = 13; i < 16; ++i)
+  {
+    REQUIRE(consumer.try_read(value));
+    REQUIRE_EQ(value, i);
+  }
+
+  REQUIRE(notifier.arm(consumer));
+}
+
+/***/
+TEST_CASE("event_notifier_multi_thread")
+{
+  constexpr uint64_t messages{2'000};
+
+  seqlock_queue_t seqlock_queue{64, false, 1};
+  EventNotifier notifier;
+
+  SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue, ConsumerMode::Lossless};
+
+  std::thread producer_thread{[&seqlock_queue, &notifier]()
+                              {
+                                SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue, WaitStrategy::Yield};
+                                producer.set_notifier(notifier);
+
+                                for (uint64_t i = 0; i < messages; ++i)
+                                {
+                                  producer.write(i);
+
+                                  if ((i % 16) == 0)
+                                  {
+                                    std::this_thread::sleep_for(std::chrono::microseconds{50});
+                                  }
+                                }
+                              }};
+
+  // Every message is received by waiting on the eventfd, a lost wake up times out
+  uint64_t expected{0};
+  while (expected != messages)
+  {
+    uint64_t value;
+    while (consumer.try_read(value))
+    {
+      REQUIRE_EQ(value, expected);
+      ++expected;
+    }
+
+    if ((expected != messages) && notifier.arm(consumer))
+    {
+      REQUIRE(readable(notifier.fd(), 5'000));
+      notifier.acknowledge();
+    }
+  }
+
+  producer_thread.join();
+}
+
+TEST_SUITE_END();
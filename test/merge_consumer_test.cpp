@@ -0,0 +1,183 @@
+#include "doctest/doctest.h"
+
+#include "seqlock_queue/merge_consumer.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+TEST_SUITE_BEGIN("MergeConsumer");
+
+using namespace sq;
+
+struct Event
+{
+  uint64_t timestamp;
+  uint64_t venue;
+};
+
+using seqlock_queue_t = BoundedSeqlockQueue<Event>;
+
+namespace
+{
+auto const event_timestamp = [](Event const& event) { return event.timestamp; };
+using merge_consumer_t = SeqlockQueueMergeConsumer<seqlock_queue_t, decltype(event_timestamp)>;
+} // namespace
+
+/***/
+TEST_CASE("merge_consumer_wait_forever")
+{
+  seqlock_queue_t venue_0{64};
+  seqlock_queue_t venue_1{64};
+  seqlock_queue_t venue_2{64};
+
+  SeqlockQueueProducer<seqlock_queue_t> producer_0{venue_0};
+  SeqlockQueueProducer<seqlock_queue_t> producer_1{venue_1};
+  SeqlockQueueProducer<seqlock_queue_t> producer_2{venue_2};
+
+  REQUIRE_THROWS(merge_consumer_t{{}, event_timestamp});
+
+  merge_consumer_t merge_consumer{{&venue_0, &venue_1, &venue_2}, event_timestamp};
+
+  Event event;
+  REQUIRE_FALSE(merge_consumer.try_read(event));
+
+  producer_0.write(Event{1, 0});
+  producer_0.write(Event{5, 0});
+  producer_1.write(Event{2, 1});
+  producer_1.write(Event{5, 1});
+
+  // Venue 2 could still publish an older event
+  REQUIRE_FALSE(merge_consumer.try_read(event));
+
+  producer_2.write(Event{3, 2});
+
+  REQUIRE(merge_consumer.try_read(event));
+  REQUIRE_EQ(event.timestamp, 1);
+  REQUIRE_EQ(merge_consumer.last_queue(), 0);
+
+  REQUIRE(merge_consumer.try_read(event));
+  REQUIRE_EQ(event.timestamp, 2);
+  REQUIRE_EQ(merge_consumer.last_queue(), 1);
+
+  REQUIRE(merge_consumer.try_read(event));
+  REQUIRE_EQ(event.timestamp, 3);
+  REQUIRE_EQ(event.venue, 2);
+
+  // Venue 2 is empty again
+  REQUIRE_FALSE(merge_consumer.try_read(event));
+
+  producer_2.write(Event{9, 2});
+
+  // Equal keys are returned in the order of the queues
+  REQUIRE(merge_consumer.try_read(event));
+  REQUIRE_EQ(event.timestamp, 5);
+  REQUIRE_EQ(event.venue, 0);
+
+  REQUIRE_FALSE(merge_consumer.try_read(event));
+
+  producer_0.write(Event{10, 0});
+  REQUIRE(merge_consumer.try_read(event));
+  REQUIRE_EQ(event.timestamp, 5);
+  REQUIRE_EQ(event.venue, 1);
+}
+
+/***/
+TEST_CASE("merge_consumer_wait_none")
+{
+  seqlock_queue_t venue_0{64};
+  seqlock_queue_t venue_1{64};
+
+  SeqlockQueueProducer<seqlock_queue_t> producer_0{venue_0};
+  SeqlockQueueProducer<seqlock_queue_t> producer_1{venue_1};
+
+  merge_consumer_t merge_consumer{{&venue_0, &venue_1}, event_timestamp, MergeWait::none()};
+
+  producer_0.write(Event{4, 0});
+  producer_0.write(Event{6, 0});
+
+  Event event;
+  REQUIRE(merge_consumer.try_read(event));
+  REQUIRE_EQ(event.timestamp, 4);
+
+  producer_1.write(Event{5, 1});
+
+  REQUIRE(merge_consumer.try_read(event));
+  REQUIRE_EQ(event.timestamp, 5);
+
+  REQUIRE(merge_consumer.try_read(event));
+  REQUIRE_EQ(event.timestamp, 6);
+
+  REQUIRE_FALSE(merge_consumer.try_read(event));
+}
+
+/***/
+TEST_CASE("merge_consumer_wait_for")
+{
+  seqlock_queue_t venue_0{64};
+  seqlock_queue_t venue_1{64};
+
+  SeqlockQueueProducer<seqlock_queue_t> producer_0{venue_0};
+  SeqlockQueueProducer<seqlock_queue_t> producer_1{venue_1};
+
+  merge_consumer_t merge_consumer{{&venue_0, &venue_1}, event_timestamp, MergeWait::for_ns(20'000'000)};
+
+  producer_0.write(Event{4, 0});
+
+  Event event;
+  REQUIRE_FALSE(merge_consumer.try_read(event));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds{30});
+
+  // Venue 1 has been empty for longer than the wait
+  REQUIRE(merge_consumer.try_read(event));
+  REQUIRE_EQ(event.timestamp, 4);
+
+  // Venue 0 just became empty
+  producer_1.write(Event{7, 1});
+  REQUIRE_FALSE(merge_consumer.try_read(event));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds{30});
+  REQUIRE(merge_consumer.try_read(event));
+  REQUIRE_EQ(event.timestamp, 7);
+}
+
+/***/
+TEST_CASE("merge_consumer_many_queues")
+{
+  constexpr size_t queue_count{7};
+  constexpr uint64_t messages{700};
+
+  std::vector<std::unique_ptr<seqlock_queue_t>> queues;
+  std::vector<std::unique_ptr<SeqlockQueueProducer<seqlock_queue_t>>> producers;
+  std::vector<seqlock_queue_t*> queue_pointers;
+
+  for (size_t i = 0; i < queue_count; ++i)
+  {
+    queues.push_back(std::make_unique<seqlock_queue_t>(1024));
+    producers.push_back(std::make_unique<SeqlockQueueProducer<seqlock_queue_t>>(*queues.back()));
+    queue_pointers.push_back(queues.back().get());
+  }
+
+  // Global timestamps dealt to the queues in an uneven pattern
+  for (uint64_t timestamp = 0; timestamp < messages; ++timestamp)
+  {
+    size_t const queue = (timestamp * timestamp + timestamp / 3) % queue_count;
+    producers[queue]->write(Event{timestamp, queue});
+  }
+
+  merge_consumer_t merge_consumer{queue_pointers, event_timestamp, MergeWait::none()};
+
+  Event event;
+  for (uint64_t timestamp = 0; timestamp < messages; ++timestamp)
+  {
+    REQUIRE(merge_consumer.try_read(event));
+    REQUIRE_EQ(event.timestamp, timestamp);
+    REQUIRE_EQ(merge_consumer.last_queue(), event.venue);
+  }
+
+  REQUIRE_FALSE(merge_consumer.try_read(event));
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,165 @@
+#include "doctest/doctest.h"
+
+#include "seqlock_queue/multi_message_queue.h"
+
+#include <thread>
+#include <vector>
+
+TEST_SUITE_BEGIN("MultiMessageQueue");
+
+using namespace sq;
+
+namespace
+{
+struct Heartbeat
+{
+  uint64_t sequence;
+};
+
+struct Quote
+{
+  uint64_t instrument;
+  uint64_t bid;
+  uint64_t ask;
+};
+
+struct Trade
+{
+  Trade(uint64_t instrument, uint64_t price) : instrument(instrument), price(price) {}
+
+  uint64_t instrument;
+  uint64_t price;
+  char venue[100]{};
+};
+
+template <typename... TCallbacks>
+struct Overloaded : TCallbacks...
+{
+  using TCallbacks::operator()...;
+};
+
+template <typename... TCallbacks>
+Overloaded(TCallbacks...) -> Overloaded<TCallbacks...>;
+} // namespace
+
+using multi_message_queue_t = MultiMessageSeqlockQueue<Heartbeat, Quote, Trade>;
+
+/***/
+TEST_CASE("multi_message_queue_dispatch")
+{
+  static_assert(multi_message_queue_t::value_t::index_of<Heartbeat> == 0);
+  static_assert(multi_message_queue_t::value_t::index_of<Trade> == 2);
+  static_assert(multi_message_queue_t::value_t::max_size == sizeof(Trade));
+
+  multi_message_queue_t queue{16};
+  MultiMessageSeqlockQueueProducer<multi_message_queue_t> producer{queue};
+  MultiMessageSeqlockQueueConsumer<multi_message_queue_t> consumer{queue};
+
+  std::vector<uint64_t> received;
+  auto visitor = Overloaded{[&received](Heartbeat const& heartbeat) { received.push_back(heartbeat.sequence); },
+                            [&received](Quote const& quote) { received.push_back(quote.bid * 10 + quote.ask); },
+                            [&received](Trade const& trade) { received.push_back(trade.price + 1000); }};
+
+  REQUIRE_FALSE(consumer.try_read(visitor));
+
+  producer.write(Quote{1, 4, 5});
+  producer.write(Heartbeat{7});
+  producer.emplace<Trade>(uint64_t{3}, uint64_t{99});
+
+  REQUIRE(consumer.try_read(visitor));
+  REQUIRE(consumer.try_read(visitor));
+  REQUIRE(consumer.try_read(visitor));
+  REQUIRE_FALSE(consumer.try_read(visitor));
+
+  REQUIRE_EQ(received, std::vector<uint64_t>{45, 7, 1099});
+  REQUIRE_EQ(consumer.consumer().sequence(), 3);
+}
+
+/***/
+TEST_CASE("multi_message_queue_lapped")
+{
+  multi_message_queue_t queue{4};
+  MultiMessageSeqlockQueueProducer<multi_message_queue_t> producer{queue};
+  MultiMessageSeqlockQueueConsumer<multi_message_queue_t> consumer{queue};
+
+  for (uint64_t i = 0; i < 6; ++i)
+  {
+    producer.write(Heartbeat{i});
+  }
+
+  // The consumer continues with the oldest message still in the queue
+  std::vector<uint64_t> received;
+  auto visitor = Overloaded{[&received](Heartbeat const& heartbeat) { received.push_back(heartbeat.sequence); },
+                            [](Quote const&) {}, [](Trade const&) {}};
+
+  while (consumer.try_read(visitor))
+  {
+  }
+
+  REQUIRE_EQ(received, std::vector<uint64_t>{4, 5});
+}
+
+/***/
+TEST_CASE("multi_message_queue_multi_thread")
+{
+  constexpr uint64_t messages{200'000};
+
+  multi_message_queue_t queue{256, false, 1};
+  MultiMessageSeqlockQueueConsumer<multi_message_queue_t> consumer{queue, ConsumerMode::Lossless};
+
+  std::thread producer_thread{[&queue]()
+                              {
+                                MultiMessageSeqlockQueueProducer<multi_message_queue_t> producer{queue,
+                                                                                                 WaitStrategy::Yield};
+
+                                for (uint64_t i = 0; i < messages; ++i)
+                                {
+                                  if (i % 3 == 0)
+                                  {
+                                    producer.write(Heartbeat{i});
+                                  }
+                                  else if (i % 3 == 1)
+                                  {
+                                    producer.write(Quote{i, i + 1, i + 2});
+                                  }
+                                  else
+                                  {
+                                    producer.emplace<Trade>(i, i * 2);
+                                  }
+                                }
+                              }};
+
+  uint64_t expected{0};
+  auto visitor = Overloaded{[&expected](Heartbeat const& heartbeat)
+                            {
+                              REQUIRE_EQ(expected % 3, 0);
+                              REQUIRE_EQ(heartbeat.sequence, expected);
+                            },
+                            [&expected](Quote const& quote)
+                            {
+                              REQUIRE_EQ(expected % 3, 1);
+                              REQUIRE_EQ(quote.instrument, expected);
+                              REQUIRE_EQ(quote.ask, expected + 2);
+                            },
+                            [&expected](Trade const& trade)
+                            {
+                              REQUIRE_EQ(expected % 3, 2);
+                              REQUIRE_EQ(trade.price, expected * 2);
+                            }};
+
+  while (expected != messages)
+  {
+    if (consumer.try_read(visitor))
+    {
+      ++expected;
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  producer_thread.join();
+}
+
+TEST_SUITE_END();
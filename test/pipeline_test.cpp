@@ -0,0 +1,156 @@
+#include "doctest/doctest.h"
+
+#include "seqlock_queue/pipeline.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_SUITE_BEGIN("Pipeline");
+
+using namespace sq;
+
+struct Test1
+{
+  uint64_t x;
+  uint64_t y;
+  uint32_t z;
+};
+
+/***/
+TEST_CASE("pipeline_stages_single_thread")
+{
+  constexpr size_t capacity{16};
+
+  using seqlock_queue_t = BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity, false, 3};
+
+  SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+
+  // decode -> enrich -> publish
+  SeqlockQueueStage<seqlock_queue_t> decode{seqlock_queue};
+  SeqlockQueueStage<seqlock_queue_t> enrich{seqlock_queue, {&decode}};
+  SeqlockQueueStage<seqlock_queue_t> publish{seqlock_queue, {&enrich}};
+
+  REQUIRE_THROWS(SeqlockQueueStage<seqlock_queue_t>{seqlock_queue});
+
+  StageSideArray<uint64_t> decoded{capacity};
+  StageSideArray<uint64_t> enriched{capacity};
+
+  for (uint32_t i = 0; i < 10; ++i)
+  {
+    producer.write(Test1{i, i, i});
+  }
+
+  // the later stages wait for the earlier ones
+  REQUIRE_EQ(enrich.process([](Test1 const&, uint64_t) {}), 0);
+
+  REQUIRE_EQ(decode.process([&decoded](Test1 const& value, uint64_t sequence)
+                            {
+                              REQUIRE_EQ(value.x, sequence);
+                              decoded[sequence] = value.x * 2;
+                            },
+                            4),
+             4);
+
+  REQUIRE_EQ(enrich.process([&decoded, &enriched](Test1 const&, uint64_t sequence)
+                            { enriched[sequence] = decoded[sequence] + 1; }),
+             4);
+
+  REQUIRE_EQ(decode.process([&decoded](Test1 const& value, uint64_t sequence) { decoded[sequence] = value.x * 2; }), 6);
+  REQUIRE_EQ(enrich.process([&decoded, &enriched](Test1 const&, uint64_t sequence)
+                            { enriched[sequence] = decoded[sequence] + 1; }),
+             6);
+
+  uint64_t published{0};
+  REQUIRE_EQ(publish.process([&enriched, &published](Test1 const& value, uint64_t sequence)
+                             {
+                               REQUIRE_EQ(enriched[sequence], value.x * 2 + 1);
+                               ++published;
+                             }),
+             10);
+
+  REQUIRE_EQ(published, 10);
+  REQUIRE_EQ(publish.sequence(), 10);
+
+  // the producer is gated by the slowest stage
+  for (uint32_t i = 10; i < 26; ++i)
+  {
+    REQUIRE(producer.try_write(Test1{i, i, i}));
+  }
+
+  REQUIRE_FALSE(producer.try_write(Test1{26, 26, 26}));
+  REQUIRE_EQ(decode.process([](Test1 const&, uint64_t) {}), 16);
+  REQUIRE_EQ(enrich.process([](Test1 const&, uint64_t) {}), 16);
+  REQUIRE_FALSE(producer.try_write(Test1{26, 26, 26}));
+  REQUIRE_EQ(publish.process([](Test1 const&, uint64_t) {}, 1), 1);
+  REQUIRE(producer.try_write(Test1{26, 26, 26}));
+}
+
+/***/
+TEST_CASE("pipeline_stages_multi_thread")
+{
+  constexpr size_t capacity{64};
+  constexpr uint64_t messages{100'000};
+
+  using seqlock_queue_t = BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity, false, 3};
+
+  SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue, WaitStrategy::Yield};
+
+  // two stages after the first one, the last stage depends on both
+  SeqlockQueueStage<seqlock_queue_t> decode{seqlock_queue};
+  SeqlockQueueStage<seqlock_queue_t> enrich{seqlock_queue, {&decode}};
+  SeqlockQueueStage<seqlock_queue_t> publish{seqlock_queue, {&decode, &enrich}};
+
+  StageSideArray<uint64_t> decoded{capacity};
+  StageSideArray<uint64_t> enriched{capacity};
+
+  std::thread decode_thread{[&]()
+                            {
+                              while (decode.sequence() != messages)
+                              {
+                                decode.process([&decoded](Test1 const& value, uint64_t sequence)
+                                               {
+                                                 REQUIRE_EQ(value.x, sequence);
+                                                 decoded[sequence] = value.y + 1;
+                                               });
+                                std::this_thread::yield();
+                              }
+                            }};
+
+  std::thread enrich_thread{[&]()
+                            {
+                              while (enrich.sequence() != messages)
+                              {
+                                enrich.process([&decoded, &enriched](Test1 const&, uint64_t sequence)
+                                               { enriched[sequence] = decoded[sequence] * 2; });
+                                std::this_thread::yield();
+                              }
+                            }};
+
+  std::thread publish_thread{[&]()
+                             {
+                               while (publish.sequence() != messages)
+                               {
+                                 publish.process(
+                                   [&decoded, &enriched](Test1 const& value, uint64_t sequence)
+                                   {
+                                     REQUIRE_EQ(decoded[sequence], value.y + 1);
+                                     REQUIRE_EQ(enriched[sequence], (value.y + 1) * 2);
+                                   });
+                                 std::this_thread::yield();
+                               }
+                             }};
+
+  for (uint64_t i = 0; i < messages; ++i)
+  {
+    producer.write(Test1{i, i * 3, 0});
+  }
+
+  decode_thread.join();
+  enrich_thread.join();
+  publish_thread.join();
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,200 @@
+#include "doctest/doctest.h"
+
+#include "seqlock_queue/poll_set.h"
+
+#include <utility>
+#include <vector>
+
+TEST_SUITE_BEGIN("PollSet");
+
+using namespace sq;
+
+using seqlock_queue_t = BoundedSeqlockQueue<uint64_t>;
+
+/***/
+TEST_CASE("poll_set_round_robin")
+{
+  seqlock_queue_t first{64};
+  seqlock_queue_t second{64};
+  seqlock_queue_t idle{64};
+
+  SeqlockQueueProducer<seqlock_queue_t> first_producer{first};
+  SeqlockQueueProducer<seqlock_queue_t> second_producer{second};
+
+  SeqlockQueuePollSet<seqlock_queue_t> poll_set{PollPolicy::RoundRobin, 4};
+  REQUIRE_EQ(poll_set.add(first), 0);
+  REQUIRE_EQ(poll_set.add(second), 1);
+  REQUIRE_EQ(poll_set.add(idle), 2);
+  REQUIRE_EQ(poll_set.size(), 3);
+
+  std::vector<std::pair<size_t, uint64_t>> received;
+  auto callback = [&received](size_t index, uint64_t value) { received.emplace_back(index, value); };
+
+  REQUIRE_EQ(poll_set.poll(callback), 0);
+
+  for (uint64_t i = 0; i < 10; ++i)
+  {
+    first_producer.write(i);
+  }
+
+  second_producer.write(uint64_t{100});
+
+  // A batch from every queue with messages, a busy queue does not starve the others
+  REQUIRE_EQ(poll_set.poll(callback), 5);
+  REQUIRE_EQ(received.size(), 5);
+  REQUIRE_EQ(received[0], std::make_pair(size_t{1}, uint64_t{100}));
+  REQUIRE_EQ(received[1], std::make_pair(size_t{0}, uint64_t{0}));
+  REQUIRE_EQ(received[4], std::make_pair(size_t{0}, uint64_t{3}));
+
+  REQUIRE_EQ(poll_set.poll(callback), 4);
+  REQUIRE_EQ(poll_set.poll(callback), 2);
+  REQUIRE_EQ(poll_set.poll(callback), 0);
+
+  REQUIRE_EQ(received.size(), 11);
+  REQUIRE_EQ(received.back(), std::make_pair(size_t{0}, uint64_t{9}));
+  REQUIRE_EQ(poll_set.consumer(0).sequence(), 10);
+}
+
+/***/
+TEST_CASE("poll_set_priority")
+{
+  seqlock_queue_t market_data{64};
+  seqlock_queue_t cancels{64};
+
+  SeqlockQueueProducer<seqlock_queue_t> market_data_producer{market_data};
+  SeqlockQueueProducer<seqlock_queue_t> cancels_producer{cancels};
+
+  SeqlockQueuePollSet<seqlock_queue_t> poll_set{PollPolicy::Priority, 2};
+  size_t const market_data_index = poll_set.add(market_data, 1);
+  size_t const cancels_index = poll_set.add(cancels, 10);
+
+  std::vector<std::pair<size_t, uint64_t>> received;
+  auto callback = [&received](size_t index, uint64_t value) { received.emplace_back(index, value); };
+
+  for (uint64_t i = 0; i < 3; ++i)
+  {
+    market_data_producer.write(i);
+    cancels_producer.write(100 + i);
+  }
+
+  // Market data is only read once there are no cancels left
+  REQUIRE_EQ(poll_set.poll(callback), 2);
+  REQUIRE_EQ(poll_set.poll(callback), 1);
+
+  cancels_producer.write(uint64_t{103});
+  REQUIRE_EQ(poll_set.poll(callback), 1);
+
+  REQUIRE_EQ(received.size(), 4);
+  for (auto const& [index, value] : received)
+  {
+    REQUIRE_EQ(index, cancels_index);
+  }
+  REQUIRE_EQ(received.back().second, 103);
+
+  REQUIRE_EQ(poll_set.poll(callback), 2);
+  REQUIRE_EQ(poll_set.poll(callback), 1);
+  REQUIRE_EQ(poll_set.poll(callback), 0);
+  REQUIRE_EQ(received.back(), std::make_pair(market_data_index, uint64_t{2}));
+}
+
+/***/
+TEST_CASE("poll_set_weighted")
+{
+  seqlock_queue_t heavy{64};
+  seqlock_queue_t light{64};
+
+  SeqlockQueueProducer<seqlock_queue_t> heavy_producer{heavy};
+  SeqlockQueueProducer<seqlock_queue_t> light_producer{light};
+
+  REQUIRE_THROWS(SeqlockQueuePollSet<seqlock_queue_t>{PollPolicy::Weighted, 0});
+
+  SeqlockQueuePollSet<seqlock_queue_t> poll_set{PollPolicy::Weighted, 2};
+  REQUIRE_THROWS(poll_set.add(heavy, 0));
+
+  size_t const heavy_index = poll_set.add(heavy, 3);
+  size_t const light_index = poll_set.add(light, 1);
+
+  for (uint64_t i = 0; i < 20; ++i)
+  {
+    heavy_producer.write(i);
+    light_producer.write(i);
+  }
+
+  size_t counts[2]{};
+  auto callback = [&counts](size_t index, uint64_t) { ++counts[index]; };
+
+  // 3 batches from the heavy queue for each batch from the light one
+  REQUIRE_EQ(poll_set.poll(callback), 8);
+  REQUIRE_EQ(counts[heavy_index], 6);
+  REQUIRE_EQ(counts[light_index], 2);
+
+  REQUIRE_EQ(poll_set.poll(callback), 8);
+  REQUIRE_EQ(counts[heavy_index], 12);
+  REQUIRE_EQ(counts[light_index], 4);
+}
+
+/***/
+TEST_CASE("poll_set_trimmed_queue")
+{
+  seqlock_queue_t seqlock_queue{1024};
+  SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+
+  SeqlockQueuePollSet<seqlock_queue_t> poll_set{PollPolicy::RoundRobin, 4};
+  poll_set.add(seqlock_queue);
+
+  std::vector<uint64_t> received;
+  auto callback = [&received](size_t, uint64_t value) { received.push_back(value); };
+
+  for (uint64_t i = 0; i < 1024; ++i)
+  {
+    producer.write(i);
+  }
+
+  REQUIRE_EQ(poll_set.poll(callback), 4);
+
+  // The next slot of the consumer was trimmed, the retained messages are still polled
+  producer.trim(100);
+  producer.write(uint64_t{1024});
+  REQUIRE_FALSE(poll_set.consumer(0).empty());
+
+  received.clear();
+  while (poll_set.poll(callback) != 0)
+  {
+  }
+
+  REQUIRE_EQ(received.size(), 101);
+  REQUIRE_EQ(received.front(), 924);
+  REQUIRE_EQ(received.back(), 1024);
+  REQUIRE(poll_set.consumer(0).empty());
+}
+
+/***/
+TEST_CASE("consumer_empty")
+{
+  seqlock_queue_t seqlock_queue{4};
+  SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  REQUIRE(consumer.empty());
+
+  producer.write(uint64_t{1});
+  REQUIRE_FALSE(consumer.empty());
+
+  uint64_t value;
+  REQUIRE(consumer.try_read(value));
+  REQUIRE(consumer.empty());
+
+  // A lapped consumer is not empty, the next read skips to the oldest message
+  for (uint64_t i = 0; i < 5; ++i)
+  {
+    producer.write(i);
+  }
+  REQUIRE_FALSE(consumer.empty());
+
+  // Nothing was retained ahead of a trimmed slot
+  REQUIRE(consumer.try_read(value));
+  producer.trim();
+  REQUIRE(consumer.empty());
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,165 @@
+#include "doctest/doctest.h"
+
+#include "seqlock_queue/ready_set.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+TEST_SUITE_BEGIN("ReadySet");
+
+using namespace sq;
+
+using seqlock_queue_t = BoundedSeqlockQueue<uint64_t>;
+
+/***/
+TEST_CASE("ready_set_mark_and_poll")
+{
+  // More groups than bits in a summary word
+  constexpr size_t rings{ReadySet::rings_per_group * 70u};
+  ReadySet ready_set{rings};
+
+  REQUIRE_EQ(ready_set.ring_count(), rings);
+  REQUIRE_THROWS(ready_set.mark(rings));
+  REQUIRE_THROWS(ReadySet{0});
+
+  std::vector<size_t> ready;
+  auto callback = [&ready](size_t ring) { ready.push_back(ring); };
+
+  REQUIRE_EQ(ready_set.poll(callback), 0);
+
+  std::vector<size_t> const marked{0, 1, 63, 64, 511, 512, 4097, 33000, rings - 1};
+  for (size_t ring : marked)
+  {
+    ready_set.mark(ring);
+  }
+
+  // Marking a ring twice reports it once
+  ready_set.mark(4097);
+
+  REQUIRE_EQ(ready_set.poll(callback), marked.size());
+  REQUIRE_EQ(ready, marked);
+
+  ready.clear();
+  REQUIRE_EQ(ready_set.poll(callback), 0);
+
+  ready_set.mark(42);
+  REQUIRE_EQ(ready_set.poll(callback), 1);
+  REQUIRE_EQ(ready.front(), 42);
+}
+
+/***/
+TEST_CASE("ready_set_producer")
+{
+  constexpr size_t rings{1000};
+  ReadySet ready_set{rings};
+
+  std::vector<std::unique_ptr<seqlock_queue_t>> queues;
+  std::vector<std::unique_ptr<SeqlockQueueProducer<seqlock_queue_t>>> producers;
+  std::vector<std::unique_ptr<SeqlockQueueConsumer<seqlock_queue_t>>> consumers;
+
+  for (size_t i = 0; i < rings; ++i)
+  {
+    queues.push_back(std::make_unique<seqlock_queue_t>(16));
+    producers.push_back(std::make_unique<SeqlockQueueProducer<seqlock_queue_t>>(*queues.back()));
+    producers.back()->set_ready_set(ready_set, i);
+    consumers.push_back(std::make_unique<SeqlockQueueConsumer<seqlock_queue_t>>(*queues.back()));
+  }
+
+  producers[7]->write(uint64_t{7});
+  producers[7]->write(uint64_t{8});
+
+  uint64_t const group[2]{999, 1000};
+  producers[999]->write_group(group, 2);
+
+  std::vector<uint64_t> received;
+  auto drain = [&consumers, &received](size_t ring)
+  {
+    uint64_t value;
+    while (consumers[ring]->try_read(value))
+    {
+      received.push_back(value);
+    }
+  };
+
+  REQUIRE_EQ(ready_set.poll(drain), 2);
+  REQUIRE_EQ(received, std::vector<uint64_t>{7, 8, 999, 1000});
+
+  REQUIRE_EQ(ready_set.poll(drain), 0);
+}
+
+/***/
+TEST_CASE("ready_set_multi_thread")
+{
+  constexpr size_t rings{64};
+  constexpr uint64_t messages_per_ring{20'000};
+
+  ReadySet ready_set{rings * 20};
+
+  std::vector<std::unique_ptr<seqlock_queue_t>> queues;
+  std::vector<std::unique_ptr<SeqlockQueueConsumer<seqlock_queue_t>>> consumers;
+
+  for (size_t i = 0; i < rings; ++i)
+  {
+    queues.push_back(std::make_unique<seqlock_queue_t>(1024, false, 1));
+    consumers.push_back(
+      std::make_unique<SeqlockQueueConsumer<seqlock_queue_t>>(*queues.back(), ConsumerMode::Lossless));
+  }
+
+  // Two producer threads, each writing to every other ring, spread over several groups
+  std::vector<std::thread> threads;
+  for (size_t thread = 0; thread < 2; ++thread)
+  {
+    threads.emplace_back(
+      [&queues, &ready_set, thread]()
+      {
+        std::vector<std::unique_ptr<SeqlockQueueProducer<seqlock_queue_t>>> producers;
+        for (size_t ring = thread; ring < rings; ring += 2)
+        {
+          producers.push_back(
+            std::make_unique<SeqlockQueueProducer<seqlock_queue_t>>(*queues[ring], WaitStrategy::Yield));
+          producers.back()->set_ready_set(ready_set, ring * 20);
+        }
+
+        for (uint64_t i = 0; i < messages_per_ring; ++i)
+        {
+          for (auto& producer : producers)
+          {
+            producer->write(i);
+          }
+        }
+      });
+  }
+
+  // Every message is found through the ready set, without reading idle rings
+  std::vector<uint64_t> expected(rings, 0);
+  uint64_t remaining{rings * messages_per_ring};
+
+  while (remaining != 0)
+  {
+    ready_set.poll(
+      [&](size_t index)
+      {
+        REQUIRE_EQ(index % 20, 0);
+        size_t const ring = index / 20;
+
+        uint64_t value;
+        while (consumers[ring]->try_read(value))
+        {
+          REQUIRE_EQ(value, expected[ring]);
+          ++expected[ring];
+          --remaining;
+        }
+      });
+
+    std::this_thread::yield();
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+}
+
+TEST_SUITE_END();
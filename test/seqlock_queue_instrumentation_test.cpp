@@ -0,0 +1,120 @@
+#define SEQLOCK_QUEUE_INSTRUMENTATION
+
+#include "doctest/doctest.h"
+
+#include "seqlock_queue/seqlock_queue.h"
+
+TEST_SUITE_BEGIN("SeqlockQueueInstrumentation");
+
+using namespace sq;
+
+struct Test1
+{
+  uint64_t x;
+  uint64_t y;
+  uint32_t z;
+};
+
+/***/
+TEST_CASE("torn_read_while_callback_runs")
+{
+  constexpr size_t capacity{4};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  Test1 result;
+
+  // the consumer reads the slot while the callback is still writing it
+  producer.write(
+    [&consumer, &result](Test1& test)
+    {
+      test.x = 1;
+      REQUIRE_EQ(consumer.try_read(result), false);
+      test.y = 2;
+      test.z = 3;
+    });
+
+  REQUIRE_EQ(producer.stats().writes, 1);
+  REQUIRE_EQ(consumer.stats().torn_reads, 1);
+  REQUIRE_EQ(consumer.stats().reads, 0);
+
+  REQUIRE_EQ(consumer.try_read(result), true);
+  REQUIRE_EQ(result.x, 1);
+  REQUIRE_EQ(result.y, 2);
+  REQUIRE_EQ(result.z, 3);
+  REQUIRE_EQ(consumer.stats().reads, 1);
+}
+
+/***/
+TEST_CASE("no_torn_read_while_staged_callback_runs")
+{
+  constexpr size_t capacity{4};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  Test1 result;
+
+  for (uint32_t i = 0; i < 10; ++i)
+  {
+    // the slot is not locked while the callback runs, the consumer sees no new message
+    producer.write_staged(
+      [&consumer, &result, i](Test1& test)
+      {
+        test.x = i;
+        REQUIRE_EQ(consumer.try_read(result), false);
+        test.y = i + 1;
+        test.z = i + 2;
+      });
+
+    REQUIRE_EQ(consumer.try_read(result), true);
+    REQUIRE_EQ(result.x, i);
+    REQUIRE_EQ(result.y, i + 1);
+    REQUIRE_EQ(result.z, i + 2);
+  }
+
+  REQUIRE_EQ(producer.stats().writes, 10);
+  REQUIRE_GE(producer.stats().max_locked_ticks, producer.stats().locked_ticks / 10);
+  REQUIRE_EQ(consumer.stats().torn_reads, 0);
+  REQUIRE_EQ(consumer.stats().reads, 10);
+}
+
+/***/
+TEST_CASE("packed_writes_are_counted")
+{
+  constexpr size_t capacity{4};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<uint64_t, 16>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  uint64_t result;
+
+  // counted whether or not the slots are published with a single 16 byte store
+  for (uint64_t i = 0; i < 10; ++i)
+  {
+    producer.write([i](uint64_t& value) { value = i; });
+    producer.write(i + 100);
+
+    REQUIRE_EQ(consumer.try_read(result), true);
+    REQUIRE_EQ(result, i);
+    REQUIRE_EQ(consumer.try_read(result), true);
+    REQUIRE_EQ(result, i + 100);
+  }
+
+  REQUIRE_EQ(producer.stats().writes, 20);
+  REQUIRE_GE(producer.stats().locked_ticks, producer.stats().max_locked_ticks);
+  REQUIRE_EQ(consumer.stats().reads, 20);
+  REQUIRE_EQ(consumer.stats().torn_reads, 0);
+}
+
+TEST_SUITE_END();
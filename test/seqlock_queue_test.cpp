@@ -2,6 +2,12 @@
 
 #include "seqlock_queue/seqlock_queue.h"
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
 TEST_SUITE_BEGIN("SeqlockQueue");
 
 using namespace sq;
@@ -190,9 +196,9 @@ TEST_CASE("version_wrap_around")
       });
   }
 
-  // now we have version 0 0 254 254
+  // now the first 2 slots hold the newest messages and the last 2 slots the previous lap
 
-  // Consumer stats reading and will only see 0 0 and not 254 254
+  // Consumer stats reading and will only see the first 2 slots and not the previous lap
   size_t total_reads{0};
   while (consumer.try_read(result))
   {
@@ -273,7 +279,7 @@ TEST_CASE("consume_then_version_wrap_around")
       });
   }
 
-  // now we have version 0 0 254 254 after writing the above 2 Slots,
+  // now the first 2 slots hold the newest messages after writing the above 2 Slots,
   // we expect to read only the first 2 items
 
   // read
@@ -291,4 +297,1491 @@ TEST_CASE("consume_then_version_wrap_around")
   REQUIRE_EQ(consumer.try_read(result), false);
 }
 
+/***/
+TEST_CASE("trim_retains_most_recent_messages")
+{
+  constexpr size_t capacity{1024};
+  constexpr size_t retain{100};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  for (uint32_t i = 0; i < capacity; ++i)
+  {
+    producer.write(Test1{i, i + 100u, i + 200u});
+  }
+
+  // read everything apart from the messages we retain
+  Test1 result;
+  for (uint32_t i = 0; i < capacity - retain; ++i)
+  {
+    REQUIRE_EQ(consumer.try_read(result), true);
+    REQUIRE_EQ(result.x, i);
+  }
+
+  size_t const released = producer.trim(retain);
+  REQUIRE_GT(released, 0);
+  REQUIRE_LT(released, (capacity - retain) * sizeof(seqlock_queue_t::slot_t));
+
+  // the retained messages are still there
+  for (uint32_t i = capacity - retain; i < capacity; ++i)
+  {
+    REQUIRE_EQ(consumer.try_read(result), true);
+    REQUIRE_EQ(result.x, i);
+    REQUIRE_EQ(result.y, i + 100u);
+    REQUIRE_EQ(result.z, i + 200u);
+  }
+
+  REQUIRE_EQ(consumer.try_read(result), false);
+}
+
+/***/
+TEST_CASE("trim_whole_queue_then_produce")
+{
+  constexpr size_t capacity{1024};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  Test1 result;
+
+  for (uint32_t iters = 0; iters < 3; ++iters)
+  {
+    // write and read more than a full queue so that the trimmed range wraps around
+    for (uint32_t i = 0; i < capacity + 10; ++i)
+    {
+      producer.write(Test1{i, i, i});
+      REQUIRE_EQ(consumer.try_read(result), true);
+      REQUIRE_EQ(result.x, i);
+    }
+
+    REQUIRE_GT(producer.trim(), 0);
+
+    // trimmed slots read as empty, not as stale messages
+    REQUIRE_EQ(consumer.try_read(result), false);
+  }
+
+  for (uint32_t i = 0; i < capacity; ++i)
+  {
+    producer.write(Test1{i, i + 100u, i + 200u});
+  }
+
+  for (uint32_t i = 0; i < capacity; ++i)
+  {
+    REQUIRE_EQ(consumer.try_read(result), true);
+    REQUIRE_EQ(result.x, i);
+    REQUIRE_EQ(result.y, i + 100u);
+    REQUIRE_EQ(result.z, i + 200u);
+  }
+
+  REQUIRE_EQ(consumer.try_read(result), false);
+}
+
+/***/
+TEST_CASE("trim_lagging_consumer")
+{
+  // Slots of a page each, so that the trim releases the slots the consumer is behind on
+  struct Message
+  {
+    uint64_t x;
+    uint8_t bytes[4088];
+  };
+
+  constexpr size_t capacity{64};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Message>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> lagging{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> lagging_written_over{seqlock_queue};
+
+  Message result;
+
+  for (uint64_t i = 0; i < capacity; ++i)
+  {
+    producer.write([i](Message& message) { message.x = i; });
+  }
+
+  for (uint64_t i = 0; i < 10; ++i)
+  {
+    REQUIRE(lagging.try_read(result));
+    REQUIRE(lagging_written_over.try_read(result));
+  }
+
+  REQUIRE_GT(producer.trim(4), 0);
+
+  // The next slot of the consumer was trimmed, it continues with the retained messages
+  REQUIRE(lagging.try_read(result));
+  REQUIRE_EQ(result.x, 60);
+
+  for (uint64_t i = capacity; i < capacity + 20; ++i)
+  {
+    producer.write([i](Message& message) { message.x = i; });
+  }
+
+  for (uint64_t i = 61; i < capacity + 20; ++i)
+  {
+    REQUIRE(lagging.try_read(result));
+    REQUIRE_EQ(result.x, i);
+  }
+  REQUIRE_FALSE(lagging.try_read(result));
+
+  // The next slot of this consumer was trimmed and then written again, it does not skip to that
+  // message but continues with the retained messages as well
+  for (uint64_t i = 60; i < capacity + 20; ++i)
+  {
+    REQUIRE(lagging_written_over.try_read(result));
+    REQUIRE_EQ(result.x, i);
+  }
+  REQUIRE_FALSE(lagging_written_over.try_read(result));
+}
+
+/***/
+TEST_CASE("trim_lagging_consumer_retain_none")
+{
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<uint64_t>;
+  seqlock_queue_t seqlock_queue{16};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  uint64_t result;
+
+  for (uint64_t i = 0; i < 16; ++i)
+  {
+    producer.write(i);
+  }
+
+  REQUIRE(consumer.try_read(result));
+  REQUIRE(consumer.try_read(result));
+
+  producer.trim();
+
+  // Nothing was retained, the consumer waits for the first message written after the trim
+  REQUIRE(consumer.empty());
+  REQUIRE_FALSE(consumer.try_read(result));
+  REQUIRE_FALSE(consumer.try_read(result));
+
+  producer.write(uint64_t{100});
+  REQUIRE_FALSE(consumer.empty());
+  REQUIRE(consumer.try_read(result));
+  REQUIRE_EQ(result, 100);
+  REQUIRE_EQ(consumer.sequence(), 17);
+  REQUIRE(consumer.empty());
+}
+
+/***/
+TEST_CASE("trim_concurrent_reader")
+{
+  // A ring large enough that resetting the trimmed slots takes a while
+  constexpr size_t capacity{1u << 16};
+  constexpr size_t retain{8};
+  constexpr uint32_t rounds{50};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<uint64_t>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+
+  // Positioned on the oldest message before each trim, the first one the trim resets
+  sq::SeqlockQueueConsumer<seqlock_queue_t> behind{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> latest{seqlock_queue};
+
+  // The write index of the producer before its last trim, after that trim and after the reader
+  // checked the queue once after that trim. The producer does not write while the reader checks.
+  std::atomic<uint64_t> written{0};
+  std::atomic<uint64_t> trimmed{0};
+  std::atomic<uint64_t> checked{0};
+  std::atomic<bool> done{false};
+
+  std::thread reader{[&]()
+                     {
+                       uint64_t result;
+
+                       while (!done.load())
+                       {
+                         uint64_t const write_index = written.load();
+
+                         if ((write_index == 0) || (checked.load() == write_index))
+                         {
+                           std::this_thread::yield();
+                           continue;
+                         }
+
+                         uint64_t const trim_write_index = trimmed.load();
+
+                         // The slots a trim resets are never seen with the indices of the previous trim
+                         REQUIRE_FALSE(behind.empty());
+
+                         latest.seek(sq::StartPosition::latest());
+                         REQUIRE_EQ(latest.sequence(), write_index);
+
+                         // Messages written after the previous trim that this trim resets are
+                         // overwritten, not yet to be written
+                         REQUIRE_NE(latest.try_get(write_index - capacity, result), sq::ReadResult::Empty);
+                         REQUIRE_EQ(latest.try_get(write_index - 1, result), sq::ReadResult::Success);
+
+                         if (trim_write_index == write_index)
+                         {
+                           checked.store(write_index);
+                         }
+                       }
+                     }};
+
+  uint64_t write_index{0};
+
+  for (uint32_t round = 0; round < rounds; ++round)
+  {
+    // Not a multiple of the capacity, so that the trimmed range wraps around the end of the ring
+    for (size_t i = 0; i < capacity + 3; ++i)
+    {
+      producer.write(write_index++);
+    }
+
+    REQUIRE_EQ(behind.resume(write_index - capacity), sq::ReadResult::Success);
+
+    written.store(write_index);
+    producer.trim(retain);
+    trimmed.store(write_index);
+
+    while (checked.load() != write_index)
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  done.store(true);
+  reader.join();
+}
+
+/***/
+TEST_CASE("consumer_save_position_and_resume")
+{
+  constexpr size_t capacity{64};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+
+  std::atomic<uint64_t> saved{0};
+
+  for (uint32_t i = 0; i < 50; ++i)
+  {
+    producer.write(Test1{i, i, i});
+  }
+
+  Test1 result;
+
+  {
+    sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+    REQUIRE_EQ(consumer.resume(saved.load()), sq::ReadResult::Success);
+    consumer.save_position(&saved, 10);
+
+    for (uint32_t i = 0; i < 25; ++i)
+    {
+      REQUIRE(consumer.try_read(result));
+    }
+
+    // saved every 10 messages
+    REQUIRE_EQ(saved.load(), 20);
+  }
+
+  // saved when the consumer is destroyed
+  REQUIRE_EQ(saved.load(), 25);
+
+  {
+    sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue, sq::ConsumerMode::Lossy,
+                                                       sq::StartPosition::latest()};
+    REQUIRE_EQ(consumer.resume(saved.load()), sq::ReadResult::Success);
+    consumer.save_position(&saved, 10);
+
+    REQUIRE(consumer.try_read(result));
+    REQUIRE_EQ(result.x, 25);
+  }
+
+  REQUIRE_EQ(saved.load(), 26);
+
+  // the saved position is overwritten, the consumer starts at the oldest message
+  for (uint32_t i = 50; i < 100; ++i)
+  {
+    producer.write(Test1{i, i, i});
+  }
+
+  {
+    sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+    REQUIRE_EQ(consumer.resume(saved.load()), sq::ReadResult::Overwritten);
+    REQUIRE_EQ(consumer.sequence(), 36);
+  }
+
+  // a position the queue did not reach yet
+  {
+    sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue, sq::ConsumerMode::Lossy,
+                                                       sq::StartPosition::latest()};
+    REQUIRE_EQ(consumer.resume(1000), sq::ReadResult::Empty);
+    REQUIRE_EQ(consumer.sequence(), 100);
+  }
+}
+
+/***/
+TEST_CASE("slot_size")
+{
+  // The 8 byte version follows the value, only values of up to 56 bytes fit one cache line
+  static_assert(sizeof(sq::Slot<std::array<std::byte, 8>, 64>) == 64);
+  static_assert(sizeof(sq::Slot<std::array<std::byte, 56>, 64>) == 64);
+  static_assert(sizeof(sq::Slot<std::array<std::byte, 57>, 64>) == 128);
+  static_assert(sizeof(sq::Slot<std::array<std::byte, 64>, 64>) == 128);
+  static_assert(sizeof(sq::Slot<std::array<std::byte, 120>, 64>) == 128);
+  static_assert(sizeof(sq::Slot<std::array<std::byte, 121>, 64>) == 192);
+}
+
+/***/
+TEST_CASE("packed_slot_produce_consume")
+{
+  struct Quote
+  {
+    int32_t price;
+    uint32_t quantity;
+  };
+
+  constexpr size_t capacity{8};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Quote, 16>;
+  static_assert(sizeof(seqlock_queue_t::slot_t) == 16, "expected a packed slot");
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  Quote result;
+  REQUIRE_EQ(consumer.try_read(result), false);
+
+  for (uint32_t iters = 0; iters < 1000; ++iters)
+  {
+    producer.write(Quote{static_cast<int32_t>(iters), iters + 1});
+    producer.write([iters](Quote& quote) { quote = Quote{-static_cast<int32_t>(iters), iters + 2}; });
+
+    REQUIRE_EQ(consumer.try_read(result), true);
+    REQUIRE_EQ(result.price, static_cast<int32_t>(iters));
+    REQUIRE_EQ(result.quantity, iters + 1);
+
+    REQUIRE_EQ(consumer.try_read(result), true);
+    REQUIRE_EQ(result.price, -static_cast<int32_t>(iters));
+    REQUIRE_EQ(result.quantity, iters + 2);
+
+    REQUIRE_EQ(consumer.try_read(result), false);
+  }
+
+  // the producer laps the consumer, which continues with the newest messages
+  for (uint32_t i = 0; i < capacity + 2; ++i)
+  {
+    producer.write(Quote{static_cast<int32_t>(i), i});
+  }
+
+  size_t total_reads{0};
+  while (consumer.try_read(result))
+  {
+    REQUIRE_EQ(result.quantity, capacity + total_reads);
+    ++total_reads;
+  }
+  REQUIRE_EQ(total_reads, 2);
+}
+
+/***/
+template <size_t Size>
+struct Payload
+{
+  uint8_t bytes[Size];
+};
+
+/***/
+template <size_t Size>
+void check_copy_kernel(sq::detail::SimdLevel level)
+{
+  Payload<Size> src;
+  for (size_t i = 0; i < Size; ++i)
+  {
+    src.bytes[i] = static_cast<uint8_t>(i * 7u + 1u);
+  }
+
+  Payload<Size> dst{};
+  sq::detail::copy_value(dst, src, level);
+  REQUIRE_EQ(std::memcmp(dst.bytes, src.bytes, Size), 0);
+}
+
+/***/
+TEST_CASE("copy_kernels")
+{
+  std::vector<sq::detail::SimdLevel> kernels{sq::detail::SimdLevel::Scalar};
+
+#if defined(SEQLOCK_QUEUE_CPU_DISPATCH)
+  if (__builtin_cpu_supports("avx2"))
+  {
+    kernels.push_back(sq::detail::SimdLevel::Avx2);
+  }
+
+  if (__builtin_cpu_supports("avx512f"))
+  {
+    kernels.push_back(sq::detail::SimdLevel::Avx512);
+  }
+#endif
+
+  for (auto kernel : kernels)
+  {
+    check_copy_kernel<256>(kernel);
+    check_copy_kernel<520>(kernel);
+    check_copy_kernel<1000>(kernel);
+    check_copy_kernel<1520>(kernel);
+    check_copy_kernel<2048>(kernel);
+    check_copy_kernel<2049>(kernel);
+  }
+}
+
+/***/
+TEST_CASE("produce_consume_large_payload")
+{
+  using payload_t = Payload<1000>;
+
+  constexpr size_t capacity{16};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<payload_t>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  payload_t value;
+  payload_t result;
+
+  for (uint32_t iters = 0; iters < 100; ++iters)
+  {
+    for (uint32_t i = 0; i < capacity; ++i)
+    {
+      std::memset(value.bytes, static_cast<int>(iters + i), sizeof(value.bytes));
+      producer.write(value);
+    }
+
+    for (uint32_t i = 0; i < capacity; ++i)
+    {
+      REQUIRE_EQ(consumer.try_read(result), true);
+      REQUIRE_EQ(result.bytes[0], static_cast<uint8_t>(iters + i));
+      REQUIRE_EQ(result.bytes[sizeof(result.bytes) - 1], static_cast<uint8_t>(iters + i));
+    }
+
+    REQUIRE_EQ(consumer.try_read(result), false);
+  }
+}
+
+/***/
+template <size_t Size>
+void check_write_non_temporal()
+{
+  using payload_t = Payload<Size>;
+
+  constexpr size_t capacity{8};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<payload_t>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  payload_t value;
+  payload_t result;
+
+  for (uint32_t iters = 0; iters < 20; ++iters)
+  {
+    for (uint32_t i = 0; i < capacity; ++i)
+    {
+      for (size_t j = 0; j < Size; ++j)
+      {
+        value.bytes[j] = static_cast<uint8_t>(iters + i + j);
+      }
+      producer.write_non_temporal(value);
+    }
+
+    for (uint32_t i = 0; i < capacity; ++i)
+    {
+      REQUIRE_EQ(consumer.try_read(result), true);
+      for (size_t j = 0; j < Size; ++j)
+      {
+        REQUIRE_EQ(result.bytes[j], static_cast<uint8_t>(iters + i + j));
+      }
+    }
+
+    REQUIRE_EQ(consumer.try_read(result), false);
+  }
+}
+
+/***/
+TEST_CASE("write_non_temporal")
+{
+  check_write_non_temporal<8>();
+  check_write_non_temporal<24>();
+  check_write_non_temporal<1000>();
+  check_write_non_temporal<1003>();
+}
+
+/***/
+TEST_CASE("published_run")
+{
+  constexpr size_t capacity{64};
+
+  using slot_t = sq::Slot<Test1, 64>;
+  std::vector<slot_t> slots(capacity);
+
+  // slots [0, 36) hold the second lap, messages [64, 100), the rest the first lap
+  for (uint64_t i = 0; i < capacity; ++i)
+  {
+    uint64_t const sequence = i < 36 ? i + capacity : i;
+
+    // the group flags do not end the run
+    uint64_t const flags = (i % 3 == 0) ? sq::detail::VERSION_GROUP_FLAGS : 0;
+    slots[i].version.store(sq::detail::published_version(sequence) | flags);
+  }
+
+  REQUIRE_EQ(sq::detail::published_run(slots.data(), capacity - 1, 36, 1000), 64);
+  REQUIRE_EQ(sq::detail::published_run(slots.data(), capacity - 1, 36, 13), 13);
+  REQUIRE_EQ(sq::detail::published_run(slots.data(), capacity - 1, 64, 1000), 36);
+  REQUIRE_EQ(sq::detail::published_run(slots.data(), capacity - 1, 99, 1000), 1);
+  REQUIRE_EQ(sq::detail::published_run(slots.data(), capacity - 1, 100, 1000), 0);
+  REQUIRE_EQ(sq::detail::published_run(slots.data(), capacity - 1, 0, 1000), 0);
+}
+
+/***/
+TEST_CASE("try_read_batch")
+{
+  constexpr size_t capacity{1024};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  std::vector<Test1> results(100);
+  REQUIRE_EQ(consumer.try_read_batch(results.data(), results.size()), 0);
+
+  uint32_t written{0};
+  uint32_t total_reads{0};
+
+  for (uint32_t iters = 0; iters < 20; ++iters)
+  {
+    for (uint32_t i = 0; i < 1000; ++i, ++written)
+    {
+      producer.write(Test1{written, written + 100u, written + 200u});
+    }
+
+    while (size_t const count = consumer.try_read_batch(results.data(), results.size()))
+    {
+      for (size_t i = 0; i < count; ++i, ++total_reads)
+      {
+        REQUIRE_EQ(results[i].x, total_reads);
+        REQUIRE_EQ(results[i].y, total_reads + 100u);
+        REQUIRE_EQ(results[i].z, total_reads + 200u);
+      }
+    }
+
+    REQUIRE_EQ(total_reads, written);
+  }
+}
+
+/***/
+TEST_CASE("try_read_batch_lapped")
+{
+  constexpr size_t capacity{16};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  for (uint32_t i = 0; i < 2 * capacity + 5; ++i)
+  {
+    producer.write(Test1{i, i, i});
+  }
+
+  // the consumer continues with the newest messages, it does not read the previous lap
+  std::vector<Test1> results(100);
+  REQUIRE_EQ(consumer.try_read_batch(results.data(), results.size()), 5);
+
+  for (uint32_t i = 0; i < 5; ++i)
+  {
+    REQUIRE_EQ(results[i].x, 2 * capacity + i);
+  }
+
+  REQUIRE_EQ(consumer.try_read_batch(results.data(), results.size()), 0);
+}
+
+/***/
+TEST_CASE("produce_consume_with_prefetch")
+{
+  constexpr size_t capacity{64};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t, 8> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t, true> consumer{seqlock_queue};
+
+  Test1 result;
+  std::vector<Test1> results(capacity);
+
+  for (uint32_t iters = 0; iters < 100; ++iters)
+  {
+    for (uint32_t i = 0; i < capacity; ++i)
+    {
+      producer.write(Test1{iters, i, 0});
+    }
+
+    for (uint32_t i = 0; i < capacity / 2; ++i)
+    {
+      REQUIRE_EQ(consumer.try_read(result), true);
+      REQUIRE_EQ(result.x, iters);
+      REQUIRE_EQ(result.y, i);
+    }
+
+    REQUIRE_EQ(consumer.try_read_batch(results.data(), results.size()), capacity / 2);
+    REQUIRE_EQ(results[0].y, capacity / 2);
+    REQUIRE_EQ(consumer.try_read(result), false);
+  }
+}
+
+/***/
+TEST_CASE("try_read_retry")
+{
+  constexpr size_t capacity{4};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  Test1 result;
+  REQUIRE_EQ(consumer.try_read_retry(result, 10), sq::ReadResult::Empty);
+
+  // the producer can not finish the write while we retry from within the callback
+  producer.write(
+    [&consumer, &result](Test1& test)
+    {
+      test = Test1{1, 2, 3};
+      REQUIRE_EQ(consumer.try_read_retry(result, 10), sq::ReadResult::Busy);
+    });
+
+  REQUIRE_EQ(consumer.try_read_retry(result, 10), sq::ReadResult::Success);
+  REQUIRE_EQ(result.x, 1);
+  REQUIRE_EQ(result.y, 2);
+  REQUIRE_EQ(result.z, 3);
+
+  REQUIRE_EQ(consumer.try_read_retry(result, 10), sq::ReadResult::Empty);
+}
+
+/***/
+TEST_CASE("produce_consume_multi_thread")
+{
+  constexpr size_t capacity{64};
+  constexpr uint32_t messages{200'000};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+
+  std::thread consumer_thread{[&seqlock_queue]()
+                              {
+                                sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+                                Test1 result;
+                                uint64_t last{0};
+
+                                while (last != messages)
+                                {
+                                  if (consumer.try_read_retry(result, 100) == sq::ReadResult::Success)
+                                  {
+                                    // messages may be dropped but are never torn or out of order
+                                    REQUIRE_EQ(result.y, result.x * 2);
+                                    REQUIRE_EQ(result.z, result.x * 3);
+                                    REQUIRE_GT(result.x, last);
+                                    last = result.x;
+                                  }
+                                }
+                              }};
+
+  for (uint32_t i = 1; i <= messages; ++i)
+  {
+    producer.write(
+      [i](Test1& test)
+      {
+        test.x = i;
+        test.y = i * 2u;
+        test.z = i * 3u;
+      });
+  }
+
+  consumer_thread.join();
+}
+
+/***/
+TEST_CASE("lossless_consumer_gates_producer")
+{
+  constexpr size_t capacity{8};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity, false, 2};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> lossless_consumer{seqlock_queue, sq::ConsumerMode::Lossless};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> lossy_consumer{seqlock_queue};
+
+  Test1 result;
+
+  for (uint32_t i = 0; i < capacity; ++i)
+  {
+    REQUIRE_EQ(producer.try_write(Test1{i, i, i}), true);
+  }
+
+  // the lossless consumer did not read anything yet
+  REQUIRE_EQ(producer.try_write(Test1{100, 100, 100}), false);
+
+  for (uint32_t i = 0; i < 3; ++i)
+  {
+    REQUIRE_EQ(lossless_consumer.try_read(result), true);
+    REQUIRE_EQ(result.x, i);
+  }
+
+  for (uint32_t i = capacity; i < capacity + 3; ++i)
+  {
+    REQUIRE_EQ(producer.try_write([i](Test1& test) { test = Test1{i, i, i}; }), true);
+  }
+  REQUIRE_EQ(producer.try_write(Test1{100, 100, 100}), false);
+
+  // nothing was dropped for the lossless consumer
+  for (uint32_t i = 3; i < capacity + 3; ++i)
+  {
+    REQUIRE_EQ(lossless_consumer.try_read(result), true);
+    REQUIRE_EQ(result.x, i);
+  }
+  REQUIRE_EQ(lossless_consumer.try_read(result), false);
+
+  // the lossy consumer was lapped and continues with the newest messages
+  REQUIRE_EQ(lossy_consumer.try_read(result), true);
+  REQUIRE_EQ(result.x, capacity);
+}
+
+/***/
+TEST_CASE("lossless_consumer_registration")
+{
+  constexpr size_t capacity{8};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity, false, 1};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+
+  {
+    sq::SeqlockQueueConsumer<seqlock_queue_t> lossless_consumer{seqlock_queue, sq::ConsumerMode::Lossless};
+    REQUIRE_THROWS_AS(
+      sq::SeqlockQueueConsumer<seqlock_queue_t>(seqlock_queue, sq::ConsumerMode::Lossless), std::runtime_error);
+
+    for (uint32_t i = 0; i < capacity; ++i)
+    {
+      REQUIRE_EQ(producer.try_write(Test1{i, i, i}), true);
+    }
+    REQUIRE_EQ(producer.try_write(Test1{}), false);
+  }
+
+  // once unregistered the producer does not wait anymore
+  for (uint32_t i = 0; i < 3 * capacity; ++i)
+  {
+    REQUIRE_EQ(producer.try_write(Test1{i, i, i}), true);
+  }
+}
+
+/***/
+TEST_CASE("lossless_consumer_registration_after_wrap")
+{
+  constexpr size_t capacity{8};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity, false, 1};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+
+  for (uint32_t i = 0; i < 100; ++i)
+  {
+    REQUIRE(producer.try_write(Test1{i, i, i}));
+  }
+
+  // The producer only looks at the gating cursors again at 104, the consumer starts past the
+  // messages it can still overwrite until then
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue, sq::ConsumerMode::Lossless};
+  REQUIRE_EQ(consumer.sequence(), 96);
+
+  uint32_t written{100};
+  while (producer.try_write(Test1{written, written, written}))
+  {
+    ++written;
+  }
+  REQUIRE_EQ(written, 104);
+
+  // No gap, every message from the start position is read
+  Test1 result;
+  for (uint32_t i = 96; i < written; ++i)
+  {
+    REQUIRE(consumer.try_read(result));
+    REQUIRE_EQ(result.x, i);
+  }
+  REQUIRE_FALSE(consumer.try_read(result));
+
+  // The producer now writes up to 112 without looking at the cursor, moving back to the oldest
+  // message is clamped the same way
+  REQUIRE(producer.try_write(Test1{104, 104, 104}));
+  consumer.seek(sq::StartPosition::oldest());
+  REQUIRE_EQ(consumer.sequence(), 104);
+
+  for (uint32_t i = 105; i < 112; ++i)
+  {
+    REQUIRE(producer.try_write(Test1{i, i, i}));
+  }
+
+  for (uint32_t i = 104; i < 112; ++i)
+  {
+    REQUIRE(consumer.try_read(result));
+    REQUIRE_EQ(result.x, i);
+  }
+}
+
+/***/
+TEST_CASE("lossless_consumer_multi_thread")
+{
+  constexpr size_t capacity{16};
+  constexpr uint32_t messages{100'000};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity, false, 2};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue, sq::WaitStrategy::Yield};
+
+  std::atomic<uint32_t> consumers_ready{0};
+
+  auto consume = [&seqlock_queue, &consumers_ready]()
+  {
+    sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue, sq::ConsumerMode::Lossless};
+    consumers_ready.fetch_add(1);
+
+    Test1 result;
+    std::vector<Test1> results(7);
+
+    uint32_t expected{0};
+    while (expected != messages)
+    {
+      bool const read = consumer.try_read(result);
+      if (read)
+      {
+        REQUIRE_EQ(result.x, expected++);
+      }
+
+      size_t const count = consumer.try_read_batch(results.data(), results.size());
+      for (size_t i = 0; i < count; ++i)
+      {
+        REQUIRE_EQ(results[i].x, expected++);
+      }
+
+      // Let the producer run when it waits for us, e.g. on a single cpu
+      if (!read && (count == 0))
+      {
+        std::this_thread::yield();
+      }
+    }
+  };
+
+  // register both consumers before producing
+  std::thread consumer_1{consume};
+  std::thread consumer_2{consume};
+
+  while (consumers_ready.load() != 2)
+  {
+    std::this_thread::yield();
+  }
+
+  for (uint32_t i = 0; i < messages; ++i)
+  {
+    producer.write(Test1{i, i, i});
+  }
+
+  consumer_1.join();
+  consumer_2.join();
+}
+
+/***/
+TEST_CASE("write_group_try_read_group")
+{
+  constexpr size_t capacity{64};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  std::vector<Test1> group(10);
+  std::vector<Test1> results(10);
+  REQUIRE_EQ(consumer.try_read_group(results.data(), results.size()), 0);
+
+  uint32_t written{0};
+  uint32_t total_reads{0};
+
+  for (uint32_t iters = 0; iters < 100; ++iters)
+  {
+    // groups of 1 to 10 messages, and single messages in between
+    size_t const group_size = (iters % 10) + 1;
+
+    for (size_t i = 0; i < group_size; ++i, ++written)
+    {
+      group[i] = Test1{written, written + 100u, written + 200u};
+    }
+
+    producer.write_group(group.data(), group_size);
+    producer.write(Test1{written, written + 100u, written + 200u});
+    ++written;
+
+    REQUIRE_EQ(consumer.try_read_group(results.data(), results.size()), group_size);
+
+    for (size_t i = 0; i < group_size; ++i, ++total_reads)
+    {
+      REQUIRE_EQ(results[i].x, total_reads);
+      REQUIRE_EQ(results[i].z, total_reads + 200u);
+    }
+
+    REQUIRE_EQ(consumer.try_read_group(results.data(), results.size()), 1);
+    REQUIRE_EQ(results[0].x, total_reads++);
+    REQUIRE_EQ(consumer.try_read_group(results.data(), results.size()), 0);
+  }
+}
+
+/***/
+TEST_CASE("try_read_group_skips_incomplete_groups")
+{
+  constexpr size_t capacity{16};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  std::vector<Test1> group(8);
+  std::vector<Test1> results(8);
+
+  for (uint32_t i = 0; i < 8; ++i)
+  {
+    group[i] = Test1{i, i, i};
+  }
+
+  // a group larger than the results is skipped
+  producer.write_group(group.data(), 8);
+  producer.write(Test1{100, 100, 100});
+  REQUIRE_EQ(consumer.try_read_group(results.data(), 4), 1);
+  REQUIRE_EQ(results[0].x, 100);
+
+  // groups of 5 from message 9, the consumer is lapped and resumes at message 25 in the middle of
+  // the group [24, 29). The rest of that group is skipped
+  for (uint32_t i = 0; i < 4; ++i)
+  {
+    producer.write_group(group.data(), 5);
+  }
+
+  producer.write(Test1{200, 200, 200});
+  REQUIRE_EQ(consumer.try_read_group(results.data(), results.size()), 1);
+  REQUIRE_EQ(results[0].x, 200);
+  REQUIRE_EQ(consumer.try_read_group(results.data(), results.size()), 0);
+
+  // plain reads receive the messages of a group one by one
+  producer.write_group(group.data(), 3);
+  Test1 result;
+  for (uint32_t i = 0; i < 3; ++i)
+  {
+    REQUIRE(consumer.try_read(result));
+    REQUIRE_EQ(result.x, i);
+  }
+}
+
+/***/
+TEST_CASE("write_group_multi_thread")
+{
+  constexpr size_t capacity{64};
+  constexpr uint32_t groups{50'000};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+
+  std::atomic<bool> done{false};
+
+  std::thread consumer_thread{[&seqlock_queue, &done]()
+                              {
+                                sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+                                std::vector<Test1> results(16);
+
+                                while (!done.load())
+                                {
+                                  size_t const count = consumer.try_read_group(results.data(), results.size());
+
+                                  // every message of a group holds the group number and its size
+                                  for (size_t i = 0; i < count; ++i)
+                                  {
+                                    REQUIRE_EQ(results[i].x, results[0].x);
+                                    REQUIRE_EQ(results[i].y, count);
+                                    REQUIRE_EQ(results[i].z, i);
+                                  }
+                                }
+                              }};
+
+  std::vector<Test1> group(16);
+
+  for (uint32_t g = 0; g < groups; ++g)
+  {
+    uint32_t const group_size = (g % 16) + 1;
+
+    for (uint32_t i = 0; i < group_size; ++i)
+    {
+      group[i] = Test1{g, group_size, i};
+    }
+
+    producer.write_group(group.data(), group_size);
+  }
+
+  done.store(true);
+  consumer_thread.join();
+}
+
+/***/
+TEST_CASE("write_group_lossless")
+{
+  constexpr size_t capacity{16};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity, false, 1};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue, sq::ConsumerMode::Lossless};
+
+  std::vector<Test1> group(10);
+  std::vector<Test1> results(10);
+
+  REQUIRE(producer.try_write_group(group.data(), 10));
+
+  // only 6 slots are free until the consumer reads the first group
+  REQUIRE_FALSE(producer.try_write_group(group.data(), 7));
+  REQUIRE(producer.try_write_group(group.data(), 6));
+
+  REQUIRE_EQ(consumer.try_read_group(results.data(), results.size()), 10);
+  REQUIRE(producer.try_write_group(group.data(), 10));
+  REQUIRE_FALSE(producer.try_write_group(group.data(), 1));
+}
+
+/***/
+TEST_CASE("try_read_if_tagged")
+{
+  constexpr size_t capacity{64};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1, 64, 64, true>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer_mask{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer_predicate{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer_all{seqlock_queue};
+
+  Test1 result;
+  REQUIRE_FALSE(consumer_mask.try_read_if(result, sq::TagMask{1}));
+
+  uint32_t written{0};
+  uint32_t expected_mask{1};
+  uint32_t expected_predicate{2};
+  uint32_t expected_all{0};
+
+  for (uint32_t iters = 0; iters < 10; ++iters)
+  {
+    // the tag is the bit of message % 4, the callback and the value overloads both store it
+    for (uint32_t i = 0; i < 30; ++i, ++written)
+    {
+      if (written % 2 == 0)
+      {
+        producer.write(Test1{written, written, written}, uint64_t{1} << (written % 4));
+      }
+      else
+      {
+        producer.write([written](Test1& value) { value = Test1{written, written, written}; },
+                       uint64_t{1} << (written % 4));
+      }
+    }
+
+    // messages % 4 == 1 or 3
+    while (consumer_mask.try_read_if(result, sq::TagMask{0b1010}))
+    {
+      REQUIRE_EQ(result.x, expected_mask);
+      expected_mask += 2;
+    }
+
+    REQUIRE_EQ(expected_mask, written + 1);
+
+    std::vector<Test1> results(4);
+    while (size_t const count =
+             consumer_predicate.try_read_batch_if(results.data(), results.size(), [](uint64_t tag) { return tag == 4; }))
+    {
+      // messages % 4 == 2
+      for (size_t i = 0; i < count; ++i)
+      {
+        REQUIRE_EQ(results[i].x, expected_predicate);
+        expected_predicate += 4;
+      }
+    }
+
+    while (consumer_all.try_read(result))
+    {
+      REQUIRE_EQ(result.x, expected_all++);
+    }
+
+    REQUIRE_EQ(expected_all, written);
+  }
+
+  REQUIRE_EQ(expected_predicate, written + 2);
+}
+
+/***/
+TEST_CASE("find_write_index")
+{
+  constexpr size_t capacity{16};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  using slot_t = seqlock_queue_t::slot_t;
+
+  for (uint64_t messages = 0; messages < 5 * capacity; ++messages)
+  {
+    for (size_t retain = 0; retain <= capacity; ++retain)
+    {
+      // messages are written then the queue is trimmed to `retain` and `after_trim` more are written
+      for (uint64_t after_trim = 0; after_trim < 2 * capacity; after_trim += 3)
+      {
+        std::vector<slot_t> slots(capacity);
+        uint64_t write_index{0};
+
+        auto const write = [&slots, &write_index]()
+        {
+          slots[write_index & (capacity - 1)].version.store(sq::detail::published_version(write_index));
+          ++write_index;
+        };
+
+        for (uint64_t i = 0; i < messages; ++i)
+        {
+          write();
+        }
+
+        for (uint64_t i = retain; i < capacity; ++i)
+        {
+          slots[(write_index + i - retain) & (capacity - 1)].version.store(0);
+        }
+
+        uint64_t const trim_write_index = write_index;
+
+        for (uint64_t i = 0; i < after_trim; ++i)
+        {
+          write();
+        }
+
+        REQUIRE_EQ(sq::detail::find_write_index(slots.data(), capacity, trim_write_index), write_index);
+
+        uint64_t const retained = messages < retain ? messages : retain;
+        uint64_t const expected_oldest = after_trim >= capacity - retained
+          ? write_index - capacity
+          : trim_write_index - retained;
+
+        REQUIRE_EQ(sq::detail::find_oldest_sequence(slots.data(), capacity, write_index), expected_oldest);
+      }
+    }
+  }
+}
+
+/***/
+TEST_CASE("consumer_start_position")
+{
+  constexpr size_t capacity{64};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+
+  auto const read_all = [](sq::SeqlockQueueConsumer<seqlock_queue_t>& consumer, uint32_t first, uint32_t end)
+  {
+    Test1 result;
+    for (uint32_t i = first; i < end; ++i)
+    {
+      REQUIRE(consumer.try_read(result));
+      REQUIRE_EQ(result.x, i);
+    }
+
+    REQUIRE_FALSE(consumer.try_read(result));
+  };
+
+  {
+    sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue, sq::ConsumerMode::Lossy,
+                                                       sq::StartPosition::latest()};
+    REQUIRE_EQ(consumer.sequence(), 0);
+  }
+
+  for (uint32_t i = 0; i < 100; ++i)
+  {
+    producer.write(Test1{i, i, i});
+  }
+
+  sq::SeqlockQueueConsumer<seqlock_queue_t> oldest{seqlock_queue};
+  REQUIRE_EQ(oldest.sequence(), 36);
+
+  sq::SeqlockQueueConsumer<seqlock_queue_t> latest{seqlock_queue, sq::ConsumerMode::Lossy,
+                                                   sq::StartPosition::latest()};
+  REQUIRE_EQ(latest.sequence(), 100);
+
+  sq::SeqlockQueueConsumer<seqlock_queue_t> backlog{seqlock_queue, sq::ConsumerMode::Lossy,
+                                                    sq::StartPosition::before_latest(10)};
+  REQUIRE_EQ(backlog.sequence(), 90);
+
+  sq::SeqlockQueueConsumer<seqlock_queue_t> long_backlog{seqlock_queue, sq::ConsumerMode::Lossy,
+                                                         sq::StartPosition::before_latest(1000)};
+  REQUIRE_EQ(long_backlog.sequence(), 36);
+
+  read_all(oldest, 36, 100);
+  read_all(latest, 100, 100);
+  read_all(backlog, 90, 100);
+  read_all(long_backlog, 36, 100);
+
+  producer.write(Test1{100, 100, 100});
+  read_all(latest, 100, 101);
+
+  // after a trim only the retained messages are available
+  producer.trim(5);
+  latest.seek(sq::StartPosition::oldest());
+  read_all(latest, 96, 101);
+
+  producer.trim();
+  latest.seek(sq::StartPosition::oldest());
+  REQUIRE_EQ(latest.sequence(), 101);
+
+  producer.write(Test1{101, 101, 101});
+  read_all(latest, 101, 102);
+}
+
+/***/
+TEST_CASE("lossless_consumer_start_position")
+{
+  constexpr size_t capacity{16};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity, false, 1};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+
+  for (uint32_t i = 0; i < 40; ++i)
+  {
+    producer.write(Test1{i, i, i});
+  }
+
+  // the consumer starts at 36 and gates the producer from there
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue, sq::ConsumerMode::Lossless,
+                                                     sq::StartPosition::before_latest(4)};
+
+  for (uint32_t i = 40; i < 52; ++i)
+  {
+    REQUIRE(producer.try_write(Test1{i, i, i}));
+  }
+
+  REQUIRE_FALSE(producer.try_write(Test1{52, 52, 52}));
+
+  Test1 result;
+  REQUIRE(consumer.try_read(result));
+  REQUIRE_EQ(result.x, 36);
+  REQUIRE(producer.try_write(Test1{52, 52, 52}));
+}
+
+/***/
+TEST_CASE("try_get")
+{
+  constexpr size_t capacity{64};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  Test1 result;
+  REQUIRE_EQ(consumer.try_get(0, result), sq::ReadResult::Empty);
+
+  for (uint32_t i = 0; i < 100; ++i)
+  {
+    producer.write(Test1{i, i + 1u, i + 2u});
+  }
+
+  for (uint32_t i = 0; i < 36; ++i)
+  {
+    REQUIRE_EQ(consumer.try_get(i, result), sq::ReadResult::Overwritten);
+  }
+
+  for (uint32_t i = 36; i < 100; ++i)
+  {
+    REQUIRE_EQ(consumer.try_get(i, result), sq::ReadResult::Success);
+    REQUIRE_EQ(result.x, i);
+    REQUIRE_EQ(result.z, i + 2u);
+  }
+
+  for (uint32_t i = 100; i < 200; ++i)
+  {
+    REQUIRE_EQ(consumer.try_get(i, result), sq::ReadResult::Empty);
+  }
+
+  // the consumer did not move
+  REQUIRE_EQ(consumer.sequence(), 0);
+
+  producer.write([&consumer, &result](Test1& value)
+                 {
+                   REQUIRE_EQ(consumer.try_get(100, result), sq::ReadResult::Busy);
+                   REQUIRE_EQ(consumer.try_get(36, result), sq::ReadResult::Overwritten);
+                   value = Test1{100, 100, 100};
+                 });
+
+  REQUIRE_EQ(consumer.try_get(100, result), sq::ReadResult::Success);
+
+  // trimmed messages are gone, the ones after the trim are not written yet
+  producer.trim(10);
+  REQUIRE_EQ(consumer.try_get(90, result), sq::ReadResult::Overwritten);
+  REQUIRE_EQ(consumer.try_get(91, result), sq::ReadResult::Success);
+  REQUIRE_EQ(consumer.try_get(101, result), sq::ReadResult::Empty);
+
+  // messages written after the previous trim are overwritten once trimmed as well
+  for (uint32_t i = 101; i < 150; ++i)
+  {
+    producer.write(Test1{i, i + 1u, i + 2u});
+  }
+
+  producer.trim(10);
+  REQUIRE_EQ(consumer.try_get(101, result), sq::ReadResult::Overwritten);
+  REQUIRE_EQ(consumer.try_get(139, result), sq::ReadResult::Overwritten);
+  REQUIRE_EQ(consumer.try_get(140, result), sq::ReadResult::Success);
+  REQUIRE_EQ(result.x, 140);
+  REQUIRE_EQ(consumer.try_get(150, result), sq::ReadResult::Empty);
+}
+
+/***/
+TEST_CASE("try_get_packed_slot")
+{
+  constexpr size_t capacity{16};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<uint64_t, 16>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  for (uint64_t i = 0; i < 20; ++i)
+  {
+    producer.write(i * 10);
+  }
+
+  uint64_t result;
+  REQUIRE_EQ(consumer.try_get(3, result), sq::ReadResult::Overwritten);
+  REQUIRE_EQ(consumer.try_get(4, result), sq::ReadResult::Success);
+  REQUIRE_EQ(result, 40);
+  REQUIRE_EQ(consumer.try_get(20, result), sq::ReadResult::Empty);
+}
+
+/***/
+TEST_CASE("seek_timestamp")
+{
+  constexpr size_t capacity{64};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1, 64, 64, false, true>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  // times[i] is after the stamp of message i - 1 and not after the stamp of message i
+  std::vector<uint64_t> times;
+
+  for (uint32_t i = 0; i < 100; ++i)
+  {
+    uint64_t const previous = sq::detail::steady_clock_ns();
+    uint64_t now = previous;
+
+    while (now == previous)
+    {
+      now = sq::detail::steady_clock_ns();
+    }
+
+    times.push_back(now);
+    producer.write(Test1{i, i, i});
+  }
+
+  for (uint32_t i = 0; i < 100; ++i)
+  {
+    consumer.seek_timestamp(times[i]);
+    REQUIRE_EQ(consumer.sequence(), i < 36 ? 36 : i);
+  }
+
+  consumer.seek_timestamp(sq::detail::steady_clock_ns());
+  REQUIRE_EQ(consumer.sequence(), 100);
+
+  consumer.seek_timestamp(times[80]);
+
+  Test1 result;
+  for (uint32_t i = 80; i < 100; ++i)
+  {
+    REQUIRE(consumer.try_read(result));
+    REQUIRE_EQ(result.x, i);
+  }
+
+  REQUIRE_FALSE(consumer.try_read(result));
+}
+
+/***/
+TEST_CASE("tagged_and_timestamped")
+{
+  constexpr size_t capacity{16};
+
+  using seqlock_queue_t = sq::BoundedSeqlockQueue<Test1, 64, 64, true, true>;
+  seqlock_queue_t seqlock_queue{capacity};
+
+  sq::SeqlockQueueProducer<seqlock_queue_t> producer{seqlock_queue};
+  sq::SeqlockQueueConsumer<seqlock_queue_t> consumer{seqlock_queue};
+
+  uint64_t const start = sq::detail::steady_clock_ns();
+
+  for (uint32_t i = 0; i < 10; ++i)
+  {
+    producer.write(Test1{i, i, i}, i % 2);
+  }
+
+  consumer.seek_timestamp(start);
+  REQUIRE_EQ(consumer.sequence(), 0);
+
+  Test1 result;
+  for (uint32_t i = 1; i < 10; i += 2)
+  {
+    REQUIRE(consumer.try_read_if(result, sq::TagMask{1}));
+    REQUIRE_EQ(result.x, i);
+  }
+
+  REQUIRE_FALSE(consumer.try_read_if(result, sq::TagMask{1}));
+}
+
 TEST_SUITE_END();
\ No newline at end of file
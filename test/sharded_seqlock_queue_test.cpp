@@ -0,0 +1,165 @@
+#include "doctest/doctest.h"
+
+#include "seqlock_queue/sharded_seqlock_queue.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_SUITE_BEGIN("ShardedSeqlockQueue");
+
+using namespace sq;
+
+struct Update
+{
+  uint64_t key;
+  uint64_t sequence;
+};
+
+/***/
+TEST_CASE("sharded_queue_routes_by_key")
+{
+  using sharded_queue_t = ShardedSeqlockQueue<Update>;
+  sharded_queue_t sharded_queue{4, 64};
+
+  REQUIRE_EQ(sharded_queue.shard_count(), 4);
+  REQUIRE_EQ(sharded_queue.shard_of(6), 2);
+
+  ShardedSeqlockQueueProducer<sharded_queue_t> producer{sharded_queue};
+  ShardedSeqlockQueueConsumer<sharded_queue_t> consumer_odd{sharded_queue, {1, 3}};
+  ShardedSeqlockQueueConsumer<sharded_queue_t> consumer_all{sharded_queue, {0, 1, 2, 3}};
+
+  REQUIRE_THROWS(ShardedSeqlockQueueConsumer<sharded_queue_t>{sharded_queue, {4}});
+
+  for (uint64_t sequence = 0; sequence < 10; ++sequence)
+  {
+    for (uint64_t key = 0; key < 8; ++key)
+    {
+      if (key % 2 == 0)
+      {
+        producer.write(key, Update{key, sequence});
+      }
+      else
+      {
+        producer.write(key, [key, sequence](Update& update) { update = Update{key, sequence}; });
+      }
+    }
+  }
+
+  // the messages of each key arrive in order, the odd consumer only sees the odd keys
+  std::vector<uint64_t> next_odd(8, 0);
+  std::vector<uint64_t> next_all(8, 0);
+  Update result;
+
+  while (consumer_odd.try_read(result))
+  {
+    REQUIRE_EQ(result.key % 2, 1);
+    REQUIRE_EQ(consumer_odd.last_shard(), sharded_queue.shard_of(result.key));
+    REQUIRE_EQ(result.sequence, next_odd[result.key]++);
+  }
+
+  while (consumer_all.try_read(result))
+  {
+    REQUIRE_EQ(result.sequence, next_all[result.key]++);
+  }
+
+  for (uint64_t key = 0; key < 8; ++key)
+  {
+    REQUIRE_EQ(next_odd[key], key % 2 == 1 ? 10 : 0);
+    REQUIRE_EQ(next_all[key], 10);
+  }
+}
+
+/***/
+TEST_CASE("sharded_queue_consumer_visits_shards_in_turns")
+{
+  using sharded_queue_t = ShardedSeqlockQueue<Update>;
+  sharded_queue_t sharded_queue{4, 64};
+
+  ShardedSeqlockQueueProducer<sharded_queue_t> producer{sharded_queue};
+  ShardedSeqlockQueueConsumer<sharded_queue_t> consumer{sharded_queue, {0, 1, 2, 3}};
+
+  // two messages in every shard
+  for (uint64_t sequence = 0; sequence < 2; ++sequence)
+  {
+    for (uint64_t key = 0; key < 4; ++key)
+    {
+      producer.write(key, Update{key, sequence});
+    }
+  }
+
+  // the first read visits shard 0 first, then each read starts after the shard read last
+  Update result;
+  for (uint64_t sequence = 0; sequence < 2; ++sequence)
+  {
+    for (uint64_t key = 0; key < 4; ++key)
+    {
+      REQUIRE(consumer.try_read(result));
+      REQUIRE_EQ(consumer.last_shard(), sharded_queue.shard_of(key));
+      REQUIRE_EQ(result.key, key);
+      REQUIRE_EQ(result.sequence, sequence);
+    }
+  }
+
+  REQUIRE_FALSE(consumer.try_read(result));
+
+  // an empty pass does not move the turn
+  producer.write(3, Update{3, 2});
+  producer.write(0, Update{0, 2});
+
+  REQUIRE(consumer.try_read(result));
+  REQUIRE_EQ(result.key, 0);
+  REQUIRE(consumer.try_read(result));
+  REQUIRE_EQ(result.key, 3);
+}
+
+/***/
+TEST_CASE("sharded_queue_producer_per_thread")
+{
+  constexpr uint64_t updates{20'000};
+  constexpr uint64_t keys{16};
+
+  using sharded_queue_t = ShardedSeqlockQueue<Update>;
+  sharded_queue_t sharded_queue{4, 1024, false, 1};
+
+  // lossless, so that every update is received
+  ShardedSeqlockQueueConsumer<sharded_queue_t> consumer{sharded_queue, {0, 1, 2, 3}, ConsumerMode::Lossless};
+
+  auto produce = [&sharded_queue](std::vector<size_t> shards)
+  {
+    ShardedSeqlockQueueProducer<sharded_queue_t> producer{sharded_queue, shards, WaitStrategy::Yield};
+
+    for (uint64_t sequence = 0; sequence < updates; ++sequence)
+    {
+      for (uint64_t key = 0; key < keys; ++key)
+      {
+        size_t const shard = sharded_queue.shard_of(key);
+        if ((shard == shards[0]) || (shard == shards[1]))
+        {
+          producer.write(key, Update{key, sequence});
+        }
+      }
+    }
+  };
+
+  std::thread producer_1{produce, std::vector<size_t>{0, 1}};
+  std::thread producer_2{produce, std::vector<size_t>{2, 3}};
+
+  std::vector<uint64_t> next(keys, 0);
+  uint64_t received{0};
+  Update result;
+
+  while (received != updates * keys)
+  {
+    if (consumer.try_read(result))
+    {
+      REQUIRE_EQ(result.sequence, next[result.key]++);
+      ++received;
+    }
+  }
+
+  producer_1.join();
+  producer_2.join();
+}
+
+TEST_SUITE_END();